@@ -0,0 +1,7 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+// Delta packets of user_runtime_config_t, see runtime_sync.c
+#define SPLIT_TRANSACTION_IDS_USER RUNTIME_SYNC
@@ -11,6 +11,12 @@
 #include "host.h"
 #include "print.h"
 #include "process_unicode.h"
+#include "runtime_sync.h"
+#if defined(HLC_POINTING_ACCEL) && EECONFIG_USER_DATA_SIZE > 0
+#    include <math.h>
+#    include "eeconfig.h"
+#    include "hlc_pointing.h"
+#endif
 
 enum layers {
     _COLEMAK_DH = 0,
@@ -286,6 +292,44 @@ void process_combo_event(uint16_t combo_index, bool pressed) {
     }
 }
 
+#if defined(HLC_POINTING_ACCEL) && EECONFIG_USER_DATA_SIZE > 0
+userspace_config_t userspace_config;
+
+// Replaces the compile time acceleration curve of hlc_accel_init() with the one in the user EEPROM block. A block that
+// was never written, or a curve that can't be right, keeps the compile time one.
+// Whatever changes userspace_config.pointing.accel later has to pass it to hlc_accel_configure() as well.
+static void pointing_accel_load(void) {
+    if (!eeconfig_is_user_datablock_valid()) {
+        return;
+    }
+    eeconfig_read_user_datablock(&userspace_config);
+
+    hlc_accel_config_t config = {
+        .enabled     = userspace_config.pointing.accel.enabled,
+        .growth_rate = userspace_config.pointing.accel.growth_rate,
+        .offset      = userspace_config.pointing.accel.offset,
+        .limit       = userspace_config.pointing.accel.limit,
+        .takeoff     = userspace_config.pointing.accel.takeoff,
+    };
+    // Also catches NaN, a limit below 1 would slow the pointer down the faster it moves
+    if (!isfinite(config.growth_rate) || !isfinite(config.offset) || !isfinite(config.takeoff) || !(config.limit >= 1.0f && config.limit <= 127.0f)) {
+        return;
+    }
+    hlc_accel_configure(&config);
+}
+#endif
+
+void keyboard_post_init_user(void) {
+    runtime_sync_init();
+#if defined(HLC_POINTING_ACCEL) && EECONFIG_USER_DATA_SIZE > 0
+    pointing_accel_load();
+#endif
+}
+
+void housekeeping_task_user(void) {
+    runtime_sync_task();
+}
+
 enum {
     TD_MAC_WIN,
 };
@@ -4,4 +4,7 @@ CAPS_WORD_ENABLE = yes
 OS_DETECTION_ENABLE = yes
 CONSOLE_ENABLE = yes
 TAP_DANCE_ENABLE = yes
-COMBO_ENABLE = yes
\ No newline at end of file
+COMBO_ENABLE = yes
+
+# Replicates user_runtime_config_t to the slave half
+SRC += runtime_sync.c
@@ -17,6 +17,8 @@ typedef struct PACKED {
     hsv_t secondary;
 } dual_hsv_t;
 
+#if EECONFIG_USER_DATA_SIZE > 0
+// Only available when the keymap reserves a user EEPROM block
 typedef union PACKED {
     uint8_t raw[EECONFIG_USER_DATA_SIZE];
     struct {
@@ -89,6 +91,7 @@ typedef union PACKED {
 _Static_assert(sizeof(userspace_config_t) <= EECONFIG_USER_DATA_SIZE, "User EECONFIG block is not large enough.");
 
 extern userspace_config_t userspace_config;
+#endif
 
 typedef struct PACKED {
     bool    dirty;
@@ -0,0 +1,266 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "runtime_sync.h"
+
+#include "quantum.h"
+#include "transactions.h"
+#include "split_util.h"
+
+user_runtime_config_t userspace_runtime_state;
+
+// Bump whenever user_runtime_config_t or the field list changes, halves with different versions don't sync
+#define RUNTIME_SYNC_VERSION 2
+
+// The state is replicated field by field, only fields that changed since they were last sent go over the link
+#define FIELD(name) {offsetof(user_runtime_config_t, name), sizeof(((user_runtime_config_t *)0)->name)}
+
+// Only what QMK doesn't share on its own, both halves copy the rest from QMK (see update_split_state())
+static const struct {
+    uint8_t offset;
+    uint8_t size;
+} fields[] = {
+    FIELD(audio), FIELD(internals), FIELD(unicode), FIELD(menu_state), FIELD(keymap_config), FIELD(debug_config), FIELD(pointing),
+#ifndef SPLIT_MODS_ENABLE
+    FIELD(mods),
+#endif
+#ifndef SPLIT_LAYER_STATE_ENABLE
+    FIELD(layers),
+#endif
+#ifndef SPLIT_LED_STATE_ENABLE
+    FIELD(leds),
+#endif
+#ifndef SPLIT_WPM_ENABLE
+    FIELD(wpm_count),
+#endif
+};
+
+_Static_assert(sizeof(user_runtime_config_t) <= UINT8_MAX, "Field offsets are stored in a byte");
+_Static_assert(ARRAY_SIZE(fields) <= 16, "Dirty fields are stored in 16 bits");
+
+// Dirty bits, then the contents of every field that is set in order
+typedef struct PACKED {
+    uint8_t  version;
+    uint16_t fields;
+    uint8_t  data[RPC_M2S_BUFFER_SIZE - sizeof(uint8_t) - sizeof(uint16_t)];
+} runtime_sync_packet_t;
+
+#define PACKET_HEADER_SIZE offsetof(runtime_sync_packet_t, data)
+
+// The slave's version, and the checksum of its copy after applying a packet
+typedef struct PACKED {
+    uint8_t  version;
+    uint32_t checksum;
+} runtime_sync_reply_t;
+
+static user_runtime_config_t sent_state; // What the slave should have
+static uint16_t              dirty_fields;
+static uint32_t              last_sync;
+static uint8_t               resync_count; // Full resends in a row that ended in a mismatch
+static uint32_t              resync_time;  // When the last full resend was asked for
+static runtime_sync_stats_t  sync_stats;
+
+// Covers the replicated fields only, the others may differ for a moment while QMK syncs them
+static uint32_t state_checksum(const user_runtime_config_t *state) {
+    uint32_t hash = 2166136261UL;
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(fields); i++) {
+        const uint8_t *bytes = (const uint8_t *)state + fields[i].offset;
+        for (uint8_t j = 0; j < fields[i].size; j++) {
+            hash = (hash ^ bytes[j]) * 16777619UL;
+        }
+    }
+    return hash;
+}
+
+// Called on the slave after a packet changed its copy. QMK only reads debug_config on this half itself, anything else
+// that should follow the master (a display, the pointing settings) reads userspace_runtime_state from here.
+__attribute__((weak)) void runtime_sync_updated_user(void) {
+    debug_config = userspace_runtime_state.debug_config;
+}
+
+static void runtime_sync_slave_handler(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    const runtime_sync_packet_t *packet  = initiator2target_buffer;
+    runtime_sync_reply_t         reply   = {.version = RUNTIME_SYNC_VERSION};
+    uint8_t                      used    = 0;
+    bool                         changed = false;
+
+    if (initiator2target_buffer_size < PACKET_HEADER_SIZE || target2initiator_buffer_size < sizeof(runtime_sync_reply_t)) {
+        return;
+    }
+
+    // Fields of another version may be laid out differently, the master stops when it sees ours
+    if (packet->version == RUNTIME_SYNC_VERSION) {
+        for (uint8_t i = 0; i < ARRAY_SIZE(fields); i++) {
+            if (!(packet->fields & (1 << i))) {
+                continue;
+            }
+            if (PACKET_HEADER_SIZE + used + fields[i].size > initiator2target_buffer_size) {
+                break; // Truncated packet, the checksum tells the master to send everything again
+            }
+            uint8_t *field = (uint8_t *)&userspace_runtime_state + fields[i].offset;
+            changed |= memcmp(field, &packet->data[used], fields[i].size) != 0;
+            memcpy(field, &packet->data[used], fields[i].size);
+            used += fields[i].size;
+        }
+        reply.checksum = state_checksum(&userspace_runtime_state);
+    }
+    if (changed) {
+        runtime_sync_updated_user();
+    }
+
+    memcpy(target2initiator_buffer, &reply, sizeof(reply));
+}
+
+// Copies QMK's state into the struct, on the slave only what QMK keeps in sync itself
+static void update_split_state(bool master) {
+    user_runtime_config_t *state = &userspace_runtime_state;
+
+#ifndef SPLIT_MODS_ENABLE
+    if (master)
+#endif
+    {
+        state->mods.mods      = get_mods();
+        state->mods.weak_mods = get_weak_mods();
+#ifndef NO_ACTION_ONESHOT
+        state->mods.oneshot_mods        = get_oneshot_mods();
+        state->mods.oneshot_locked_mods = get_oneshot_locked_mods();
+#endif
+    }
+#ifndef SPLIT_LAYER_STATE_ENABLE
+    if (master)
+#endif
+    {
+        state->layers.layer_state         = layer_state;
+        state->layers.default_layer_state = default_layer_state;
+    }
+#ifndef SPLIT_LED_STATE_ENABLE
+    if (master)
+#endif
+    {
+        state->leds = host_keyboard_led_state();
+    }
+#ifdef WPM_ENABLE
+#    ifndef SPLIT_WPM_ENABLE
+    if (master)
+#    endif
+    {
+        state->wpm_count = get_current_wpm();
+    }
+#endif
+}
+
+// Copies the state the slave doesn't get from QMK into the replicated struct
+static void update_state(void) {
+    user_runtime_config_t *state = &userspace_runtime_state;
+
+    update_split_state(true);
+    state->keymap_config = keymap_config;
+    state->debug_config  = debug_config;
+#ifdef CAPS_WORD_ENABLE
+    state->internals.is_caps_word = is_caps_word_on();
+#endif
+}
+
+void runtime_sync_init(void) {
+    transaction_register_rpc(RUNTIME_SYNC, runtime_sync_slave_handler);
+    runtime_sync_mark_all();
+}
+
+void runtime_sync_mark_all(void) {
+    dirty_fields = (1 << ARRAY_SIZE(fields)) - 1;
+}
+
+// Sends one packet with as many of the changed fields as fit, or a checksum request once in a while
+void runtime_sync_task(void) {
+    static bool connected = false;
+
+    if (!is_keyboard_master()) {
+        update_split_state(false);
+        return;
+    }
+    if (!is_transport_connected()) {
+        connected = false;
+        return;
+    }
+    if (!connected) {
+        // The slave may have rebooted in the meantime, maybe with other firmware
+        runtime_sync_mark_all();
+        resync_count       = 0;
+        sync_stats.stopped = false;
+        connected          = true;
+    }
+    if (sync_stats.stopped) {
+        return;
+    }
+
+    update_state();
+    uint16_t changed_fields = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(fields); i++) {
+        if (memcmp((uint8_t *)&userspace_runtime_state + fields[i].offset, (uint8_t *)&sent_state + fields[i].offset, fields[i].size) != 0) {
+            changed_fields |= 1 << i;
+        }
+    }
+    dirty_fields |= changed_fields;
+
+    // A slave that keeps disagreeing gets more and more time between full resends, fields that changed go out right away
+    bool     backoff = resync_count && timer_elapsed32(resync_time) < ((uint32_t)RUNTIME_SYNC_BACKOFF_MS << (resync_count - 1));
+    uint16_t send    = backoff ? changed_fields : dirty_fields;
+    if (!send && (backoff || timer_elapsed32(last_sync) < RUNTIME_SYNC_CHECK_MS)) {
+        return;
+    }
+
+    runtime_sync_packet_t packet = {.version = RUNTIME_SYNC_VERSION};
+    uint8_t               used   = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(fields); i++) {
+        if (!(send & (1 << i)) || used + fields[i].size > sizeof(packet.data)) {
+            continue;
+        }
+        memcpy(&packet.data[used], (uint8_t *)&userspace_runtime_state + fields[i].offset, fields[i].size);
+        packet.fields |= 1 << i;
+        used += fields[i].size;
+    }
+
+    runtime_sync_reply_t reply = {0};
+    last_sync                  = timer_read32();
+    if (!transaction_rpc_exec(RUNTIME_SYNC, PACKET_HEADER_SIZE + used, &packet, sizeof(reply), &reply)) {
+        return; // Still dirty, tried again on the next call
+    }
+    sync_stats.packets++;
+    sync_stats.bytes += PACKET_HEADER_SIZE + used;
+
+    if (reply.version != RUNTIME_SYNC_VERSION) {
+        dprintf("runtime_sync: slave runs version %u, not %u, stopped\n", reply.version, RUNTIME_SYNC_VERSION);
+        sync_stats.stopped = true;
+        return;
+    }
+
+    // Only the fields that made it into the packet are sent now
+    for (uint8_t i = 0; i < ARRAY_SIZE(fields); i++) {
+        if (packet.fields & (1 << i)) {
+            memcpy((uint8_t *)&sent_state + fields[i].offset, (uint8_t *)&userspace_runtime_state + fields[i].offset, fields[i].size);
+        }
+    }
+    dirty_fields &= ~packet.fields;
+
+    // A full resend can take more than one packet, the slave is only compared once it has everything
+    if (dirty_fields) {
+        return;
+    }
+    if (reply.checksum == state_checksum(&sent_state)) {
+        resync_count = 0;
+    } else if (resync_count >= RUNTIME_SYNC_MAX_RESYNCS) {
+        dprintf("runtime_sync: slave still out of sync after %u resends, stopped\n", resync_count);
+        sync_stats.stopped = true;
+    } else {
+        dprintf("runtime_sync: slave out of sync, sending everything\n");
+        resync_count++;
+        resync_time = timer_read32();
+        sync_stats.resyncs++;
+        runtime_sync_mark_all();
+    }
+}
+
+const runtime_sync_stats_t *runtime_sync_get_stats(void) {
+    return &sync_stats;
+}
@@ -0,0 +1,37 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "runtime.h"
+
+// Idle time after which the master asks the slave for a checksum of its copy
+#ifndef RUNTIME_SYNC_CHECK_MS
+#    define RUNTIME_SYNC_CHECK_MS 1000
+#endif
+
+// Wait before the first full resend after a checksum mismatch, doubled for every one after it. Fields that change in the
+// meantime are still sent right away.
+#ifndef RUNTIME_SYNC_BACKOFF_MS
+#    define RUNTIME_SYNC_BACKOFF_MS 100
+#endif
+
+// Full resends in a row that may end in a mismatch before the master stops syncing until the next reconnect
+#ifndef RUNTIME_SYNC_MAX_RESYNCS
+#    define RUNTIME_SYNC_MAX_RESYNCS 5
+#endif
+
+typedef struct {
+    uint32_t packets;  // Transactions sent, checks included
+    uint32_t bytes;    // Payload bytes sent to the slave
+    uint32_t resyncs;  // Full resends after a checksum mismatch or a reconnect
+    bool     stopped;  // Gave up until the next reconnect: the slave runs another version or kept disagreeing
+} runtime_sync_stats_t;
+
+void runtime_sync_init(void);
+void runtime_sync_task(void);
+void runtime_sync_mark_all(void);
+const runtime_sync_stats_t *runtime_sync_get_stats(void);
+
+// Called on the slave when a packet changed userspace_runtime_state, the default applies debug_config
+void runtime_sync_updated_user(void);
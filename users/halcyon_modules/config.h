@@ -3,7 +3,11 @@
 
 #pragma once
 
-#define SPLIT_TRANSACTION_IDS_KB MODULE_SYNC
+#ifdef HLC_POINTING_SYNC
+#    define SPLIT_TRANSACTION_IDS_KB MODULE_SYNC, POINTING_SYNC
+#else
+#    define SPLIT_TRANSACTION_IDS_KB MODULE_SYNC
+#endif
 
 #include_next <mcuconf.h>
 
@@ -12,8 +16,11 @@
 
 #define HAL_USE_PWM TRUE
 
+// HLC_POINTING_SYNC moves the slave's pointing reports itself, see hlc_pointing_sync.c
+#ifndef HLC_POINTING_SYNC
 #define SPLIT_POINTING_ENABLE
 #define POINTING_DEVICE_COMBINED
+#endif
 
 #define HLC_BACKLIGHT_TIMEOUT 120000
 
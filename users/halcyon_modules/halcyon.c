@@ -4,7 +4,45 @@
 #include "halcyon.h"
 #include "transactions.h"
 #include "split_util.h"
-#include "_wait.h"
+#include "timer.h"
+#include "hlc_profile.h"
+#if defined(HLC_POINTING_SMOOTH) || defined(HLC_POINTING_ACCEL)
+#    include "hlc_pointing.h"
+#endif
+#ifdef HLC_POINTING_SYNC
+#    include "hlc_pointing_sync.h"
+#endif
+
+// Bump when module_sync_t changes, halves with a different version never acknowledge each other
+#define HLC_MODULE_SYNC_VERSION 1
+
+// Time between attempts while the slave hasn't acknowledged yet
+#ifndef HLC_MODULE_SYNC_RETRY_MS
+#    define HLC_MODULE_SYNC_RETRY_MS 50
+#endif
+
+// Time between syncs once acknowledged, so a slave that rebooted without dropping the transport gets it again
+#ifndef HLC_MODULE_SYNC_REFRESH_MS
+#    define HLC_MODULE_SYNC_REFRESH_MS 5000
+#endif
+
+typedef struct {
+    uint8_t  version;
+    uint8_t  sequence;
+    module_t module;
+} module_sync_t;
+
+// Sent back by the slave, echoes the request it accepted
+typedef struct {
+    uint8_t version;
+    uint8_t sequence;
+} module_sync_ack_t;
+
+typedef enum {
+    MODULE_SYNC_DISCONNECTED,
+    MODULE_SYNC_PENDING,
+    MODULE_SYNC_DONE,
+} module_sync_state_t;
 
 __attribute__((weak)) bool module_post_init_kb(void) {
     return module_post_init_user();
@@ -16,6 +54,11 @@ __attribute__((weak)) bool display_module_housekeeping_task_kb(bool second_displ
     return display_module_housekeeping_task_user(second_display);
 }
 
+// Keycodes handled by the module, false when the key is used up
+__attribute__((weak)) bool module_process_record_kb(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
 __attribute__((weak)) bool module_post_init_user(void) {
     return true;
 }
@@ -59,14 +102,70 @@ void backlight_suspend(void) {
 }
 
 void module_sync_slave_handler(uint8_t initiator2target_buffer_size, const void* initiator2target_buffer, uint8_t target2initiator_buffer_size, void* target2initiator_buffer) {
-    if (initiator2target_buffer_size == sizeof(module)) {
-        memcpy(&module_master, initiator2target_buffer, sizeof(module_master));
+    module_sync_t sync;
+
+    if (initiator2target_buffer_size != sizeof(sync) || target2initiator_buffer_size < sizeof(module_sync_ack_t)) {
+        return;
+    }
+    memcpy(&sync, initiator2target_buffer, sizeof(sync));
+    if (sync.version != HLC_MODULE_SYNC_VERSION) {
+        return; // No acknowledgement, the master keeps retrying
+    }
+
+    module_master = sync.module;
+
+    module_sync_ack_t ack = {.version = HLC_MODULE_SYNC_VERSION, .sequence = sync.sequence};
+    memcpy(target2initiator_buffer, &ack, sizeof(ack));
+}
+
+// Master side of the module sync, one attempt per call at most and no waiting for the slave
+static void module_sync_task(void) {
+    static module_sync_state_t state = MODULE_SYNC_DISCONNECTED;
+    static uint8_t             sequence = 0;
+    static uint32_t            last_attempt = 0;
+
+    // Start over when the cable is unplugged or the slave stops responding
+    if (!is_transport_connected()) {
+        state = MODULE_SYNC_DISCONNECTED;
+        return;
+    }
+
+    uint32_t interval = (state == MODULE_SYNC_DONE) ? HLC_MODULE_SYNC_REFRESH_MS : HLC_MODULE_SYNC_RETRY_MS;
+    if (state != MODULE_SYNC_DISCONNECTED && timer_elapsed32(last_attempt) < interval) {
+        return;
+    }
+
+    // A new sequence number for every attempt, so an old acknowledgement never matches
+    module_sync_t     sync = {.version = HLC_MODULE_SYNC_VERSION, .sequence = ++sequence, .module = module};
+    module_sync_ack_t ack  = {0};
+    last_attempt           = timer_read32();
+
+    bool acked = transaction_rpc_exec(MODULE_SYNC, sizeof(sync), &sync, sizeof(ack), &ack) && ack.version == HLC_MODULE_SYNC_VERSION && ack.sequence == sync.sequence;
+    if (!acked) {
+        state = MODULE_SYNC_PENDING;
+        return;
+    }
+
+    if (state != MODULE_SYNC_DONE) {
+        // Good moment to make sure the backlight wakes up after boot for both halves
+        backlight_wakeup();
+        state = MODULE_SYNC_DONE;
     }
 }
 
 void keyboard_post_init_kb(void) {
     // Register module sync split transaction
     transaction_register_rpc(MODULE_SYNC, module_sync_slave_handler);
+#ifdef HLC_POINTING_SYNC
+    hlc_pointing_sync_init();
+#endif
+
+#ifdef HLC_PROFILE_ENABLE
+    hlc_profile_init();
+#endif
+#ifdef HLC_POINTING_ACCEL
+    hlc_accel_init(); // Compile time curve, the keymap can load its own in keyboard_post_init_user()
+#endif
 
     // Do any post init for modules
     module_post_init_kb();
@@ -75,52 +174,110 @@ void keyboard_post_init_kb(void) {
     keyboard_post_init_user();
 }
 
-void housekeeping_task_kb(void) {
-    if (is_keyboard_master()) {
-        static bool synced = false;
+#ifdef HLC_PROFILE_ENABLE
+static uint32_t loop_start;
+static uint32_t scan_start;
+static bool     loop_started = false;
 
-        if (!synced) {
-            if(is_transport_connected()) {
-                transaction_rpc_send(MODULE_SYNC, sizeof(module), &module); // Sync to slave
-                wait_ms(10);
-                // Good moment to make sure the backlight wakes up after boot for both halves
-                backlight_wakeup();
-                synced = true;
-            }
+// Called at the end of the matrix scan, the scan zone starts where housekeeping left off
+void matrix_scan_kb(void) {
+    if (loop_started) {
+        hlc_profile_record(HLC_PROFILE_SCAN, scan_start);
+    }
+    matrix_scan_user();
+}
+
+#endif
+
+bool process_record_kb(uint16_t keycode, keyrecord_t *record) {
+#ifdef HLC_PROFILE_ENABLE
+    if (keycode == HLC_PROFILE_DUMP) {
+        if (record->event.pressed) {
+            hlc_profile_dump();
         }
+        return false;
+    }
+#endif
+    if (!module_process_record_kb(keycode, record)) {
+        return false;
+    }
+    return process_record_user(keycode, record);
+}
+
+void housekeeping_task_kb(void) {
+#ifdef HLC_PROFILE_ENABLE
+    if (loop_started) {
+        hlc_profile_record(HLC_PROFILE_LOOP, loop_start);
+    }
+    loop_start   = hlc_profile_now();
+    loop_started = true;
+#endif
 
-        display_module_housekeeping_task_kb(false); // Is master so can never be the second display
+    if (is_keyboard_master()) {
+        module_sync_task();
+#ifdef HLC_POINTING_SYNC
+        hlc_pointing_sync_task();
+#endif
+
+        HLC_PROFILE(HLC_PROFILE_DISPLAY, display_module_housekeeping_task_kb(false)); // Is master so can never be the second display
     }
 
     if (!is_keyboard_master()) {
-        display_module_housekeeping_task_kb(module_master == hlc_tft_display);
+        HLC_PROFILE(HLC_PROFILE_DISPLAY, display_module_housekeeping_task_kb(module_master == hlc_tft_display));
     }
 
     // Backlight feature
-    if (last_input_activity_elapsed() <= HLC_BACKLIGHT_TIMEOUT) {
-        if (backlight_off) {
-            backlight_wakeup();
-        }
-    } else {
-        if (!backlight_off) {
-            backlight_suspend();
+    HLC_PROFILE(HLC_PROFILE_BACKLIGHT, {
+        if (last_input_activity_elapsed() <= HLC_BACKLIGHT_TIMEOUT) {
+            if (backlight_off) {
+                backlight_wakeup();
+            }
+        } else {
+            if (!backlight_off) {
+                backlight_suspend();
+            }
         }
-    }
+    });
 
-    module_housekeeping_task_kb();
+    HLC_PROFILE(HLC_PROFILE_MODULE, module_housekeeping_task_kb());
 
     housekeeping_task_user();
+
+#ifdef HLC_PROFILE_ENABLE
+    scan_start = hlc_profile_now();
+#endif
 }
 
+#ifdef HLC_POINTING_SMOOTH
+static hlc_smooth_state_t left_smooth;
+static hlc_smooth_state_t right_smooth;
+#endif
+#ifdef HLC_POINTING_ACCEL
+static hlc_accel_state_t left_accel;
+static hlc_accel_state_t right_accel;
+#endif
+
 report_mouse_t pointing_device_task_combined_kb(report_mouse_t left_report, report_mouse_t right_report) {
     // Only runs on master
+#ifndef HLC_POINTING_SYNC
     // Fixes the following bug: If master is right and master is NOT a cirque trackpad, the inputs would be inverted.
+    // With HLC_POINTING_SYNC the slave turns its own reports the right way around.
     if(module != hlc_cirque_trackpad && !is_keyboard_left()) {
         mouse_xy_report_t x = left_report.x;
         mouse_xy_report_t y = left_report.y;
         left_report.x = -x;
         left_report.y = -y;
     }
+#endif
+#ifdef HLC_POINTING_SMOOTH
+    // Before the acceleration, so the gain follows the smoothed speed
+    left_report  = hlc_smooth_apply(&left_smooth, left_report);
+    right_report = hlc_smooth_apply(&right_smooth, right_report);
+#endif
+#ifdef HLC_POINTING_ACCEL
+    left_report  = hlc_accel_apply(&left_accel, left_report);
+    right_report = hlc_accel_apply(&right_accel, right_report);
+#endif
     return pointing_device_task_combined_user(left_report, right_report);
 }
 
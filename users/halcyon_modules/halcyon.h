@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "action.h"
+
 typedef enum module {
     none,
     hlc_none,
@@ -12,10 +14,12 @@ typedef enum module {
 } module_t;
 
 extern module_t module_master;
+extern bool     backlight_off;
 
 bool module_post_init_kb(void);
 bool module_housekeeping_task_kb(void);
 bool display_module_housekeeping_task_kb(bool second_display);
+bool module_process_record_kb(uint16_t keycode, keyrecord_t *record);
 bool module_post_init_user(void);
 bool module_housekeeping_task_user(void);
 bool display_module_housekeeping_task_user(bool second_display);
@@ -0,0 +1,122 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_core1.h"
+
+#include <stdatomic.h>
+#include "hal.h"
+#include "util.h"
+#include "wear_leveling_internal.h"
+
+static bool        launched = false;
+static bool        in_ram   = false; // Core1 never needs to be parked
+static atomic_uint park_seq; // Odd while core0 needs core1 out of flash
+static atomic_uint park_ack; // Last odd park_seq seen by core1, from RAM
+static uint32_t    parks    = 0;
+static uint8_t     flash_writes = 0; // Nesting of the backing store calls below
+
+static uint32_t core1_stack[HLC_CORE1_STACK_SIZE / sizeof(uint32_t)] __attribute__((aligned(8)));
+
+// Boot ROM handshake that starts core1 with its own stack (RP2040 datasheet, 2.8.2)
+void hlc_core1_launch(void (*entry)(void), bool entry_in_ram) {
+    const uint32_t cmds[] = {0, 0, 1, SCB->VTOR, (uint32_t)&core1_stack[ARRAY_SIZE(core1_stack)], (uint32_t)entry};
+    uint8_t        i      = 0;
+
+    if (launched) {
+        return;
+    }
+    launched = true;
+    in_ram   = entry_in_ram;
+
+    while (i < ARRAY_SIZE(cmds)) {
+        if (cmds[i] == 0) {
+            // Core1 might still be talking from an earlier attempt
+            while (SIO->FIFO_ST & SIO_FIFO_ST_VLD) {
+                (void)SIO->FIFO_RD;
+            }
+            __SEV();
+        }
+        while (!(SIO->FIFO_ST & SIO_FIFO_ST_RDY)) {
+        }
+        SIO->FIFO_WR = cmds[i];
+        __SEV();
+
+        while (!(SIO->FIFO_ST & SIO_FIFO_ST_VLD)) {
+        }
+        // Core1 echoes every word, anything else starts the sequence over
+        i = SIO->FIFO_RD == cmds[i] ? i + 1 : 0;
+    }
+}
+
+void hlc_core1_park(bool parked) {
+    unsigned seq = atomic_load(&park_seq);
+
+    if (!launched || in_ram || parked == (bool)(seq & 1)) {
+        return;
+    }
+
+    atomic_store(&park_seq, ++seq);
+    __SEV();
+
+    if (parked) {
+        parks++;
+        while (atomic_load(&park_ack) != seq) {
+        }
+    }
+}
+
+uint32_t hlc_core1_parks(void) {
+    return parks;
+}
+
+// Runs from RAM, core0 may be writing the flash while core1 waits in here
+void __not_in_flash_func(hlc_core1_yield)(void) {
+    unsigned seq = atomic_load(&park_seq);
+
+    while (seq & 1) {
+        atomic_store(&park_ack, seq);
+        __WFE();
+        seq = atomic_load(&park_seq);
+    }
+}
+
+// Core1 code running from flash has to stay out of it while the flash is written. Every EEPROM write on the RP2040 (eeconfig,
+// VIA, the keymaps' own settings) ends up in the wear leveling backing store, rules.mk has the linker send its erase and
+// write calls through these wrappers.
+bool __real_backing_store_erase(void);
+bool __real_backing_store_write(uint32_t address, backing_store_int_t value);
+bool __real_backing_store_write_bulk(uint32_t address, backing_store_int_t *values, size_t item_count);
+
+static void flash_write_begin(void) {
+    if (flash_writes++ == 0) {
+        hlc_core1_park(true);
+    }
+}
+
+static void flash_write_end(void) {
+    if (--flash_writes == 0) {
+        hlc_core1_park(false);
+    }
+}
+
+bool __wrap_backing_store_erase(void) {
+    flash_write_begin();
+    bool ok = __real_backing_store_erase();
+    flash_write_end();
+    return ok;
+}
+
+bool __wrap_backing_store_write(uint32_t address, backing_store_int_t value) {
+    flash_write_begin();
+    bool ok = __real_backing_store_write(address, value);
+    flash_write_end();
+    return ok;
+}
+
+// The default bulk write calls backing_store_write() for every value, the nesting keeps core1 parked until the end
+bool __wrap_backing_store_write_bulk(uint32_t address, backing_store_int_t *values, size_t item_count) {
+    flash_write_begin();
+    bool ok = __real_backing_store_write_bulk(address, values, item_count);
+    flash_write_end();
+    return ok;
+}
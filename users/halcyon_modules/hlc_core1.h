@@ -0,0 +1,27 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef HLC_CORE1_STACK_SIZE
+#    define HLC_CORE1_STACK_SIZE 4096
+#endif
+
+// Places a function in RAM (the .time_critical sections of QMK's RP2040 linker scripts), like the Pico SDK macro
+#ifndef __not_in_flash_func
+#    define __not_in_flash_func(name) __attribute__((noinline, section(".time_critical." #name))) name
+#endif
+
+// Starts entry on the second RP2040 core, only the first call does anything. With in_ram entry never touches the
+// flash (code, constants or library calls), core1 then keeps running while the flash is written.
+void hlc_core1_launch(void (*entry)(void), bool in_ram);
+
+// Core0 side: keeps core1 in RAM while the flash is written, parking blocks until core1 got there
+void     hlc_core1_park(bool parked);
+uint32_t hlc_core1_parks(void);
+
+// Core1 side: has to be called regularly (and after every wake up from WFE), a park request is served in here
+void hlc_core1_yield(void);
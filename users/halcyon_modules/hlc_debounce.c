@@ -0,0 +1,169 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Per key debounce on whole matrix rows (DEBOUNCE_TYPE = custom).
+// Every key has a DEBOUNCE ms counter, stored as vertical counters: bit plane b of a row holds bit b of the
+// counters of all keys in that row, so a row of keys is counted with a handful of bitwise operations.
+//
+// By default presses are reported at once and the key is then ignored for DEBOUNCE ms, releases are only
+// reported after the key has been released for DEBOUNCE ms (like asym_eager_defer_pk).
+// With HLC_DEBOUNCE_SYM_DEFER both presses and releases wait for DEBOUNCE ms of stable input (like sym_defer_pk).
+// With HLC_MATRIX_CORE1_SCAN the scan loop on core1 debounces the keys and QMK only gets a copy of the result.
+
+#include "hlc_debounce.h"
+#include "debounce.h"
+#include "matrix.h"
+
+#include <string.h>
+
+#ifdef HLC_MATRIX_CORE1_SCAN
+// Core1 keeps scanning while the flash is written, the debounce it calls runs from RAM
+#    include "hlc_core1.h"
+#    define DEBOUNCE_FUNC(name) __not_in_flash_func(name)
+#else
+#    define DEBOUNCE_FUNC(name) name
+#endif
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#if DEBOUNCE > 255
+#    error "DEBOUNCE is limited to 255 ms"
+#elif DEBOUNCE > 127
+#    define COUNTER_BITS 8
+#elif DEBOUNCE > 63
+#    define COUNTER_BITS 7
+#elif DEBOUNCE > 31
+#    define COUNTER_BITS 6
+#elif DEBOUNCE > 15
+#    define COUNTER_BITS 5
+#elif DEBOUNCE > 7
+#    define COUNTER_BITS 4
+#elif DEBOUNCE > 3
+#    define COUNTER_BITS 3
+#else
+#    define COUNTER_BITS 2
+#endif
+
+static matrix_row_t counters[MATRIX_ROWS][COUNTER_BITS];
+static matrix_row_t running[MATRIX_ROWS]; // Keys whose counter was started by an earlier call
+#ifndef HLC_DEBOUNCE_SYM_DEFER
+static matrix_row_t locked[MATRIX_ROWS]; // Keys that were just pressed and ignore the input for now
+#endif
+static bool         counting = false; // Any counter running, nothing to do while all keys are stable
+static fast_timer_t last_time;
+
+// Keys whose counter reached DEBOUNCE
+static inline __attribute__((always_inline)) matrix_row_t counter_done(const matrix_row_t *planes) {
+    matrix_row_t done = (matrix_row_t)~0;
+
+    for (uint8_t b = 0; b < COUNTER_BITS; b++) {
+        done &= ((DEBOUNCE >> b) & 1) ? planes[b] : (matrix_row_t)~planes[b];
+    }
+    return done;
+}
+
+// Adds one to the counters of the keys in mask
+static inline __attribute__((always_inline)) void counter_increment(matrix_row_t *planes, matrix_row_t mask) {
+    for (uint8_t b = 0; b < COUNTER_BITS && mask; b++) {
+        matrix_row_t carry = planes[b] & mask;
+        planes[b] ^= mask;
+        mask = carry;
+    }
+}
+
+static inline __attribute__((always_inline)) void counter_clear(matrix_row_t *planes, matrix_row_t mask) {
+    for (uint8_t b = 0; b < COUNTER_BITS; b++) {
+        planes[b] &= ~mask;
+    }
+}
+
+void debounce_init(uint8_t num_rows) {
+    memset(counters, 0, sizeof(counters));
+    memset(running, 0, sizeof(running));
+#ifndef HLC_DEBOUNCE_SYM_DEFER
+    memset(locked, 0, sizeof(locked));
+#endif
+    counting  = false;
+    last_time = timer_read_fast();
+}
+
+void debounce_free(void) {}
+
+// now is a millisecond clock, it only has to match timer_read_fast() in the way it counts
+bool DEBOUNCE_FUNC(hlc_debounce_rows)(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed, fast_timer_t now) {
+    fast_timer_t elapsed        = TIMER_DIFF_FAST(now, last_time);
+    bool         cooked_changed = false;
+    bool         still_counting = false;
+
+    last_time = now;
+    if (!changed && !counting) {
+        return false;
+    }
+    if (elapsed > DEBOUNCE) {
+        elapsed = DEBOUNCE;
+    }
+
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t *planes = counters[row];
+        matrix_row_t  before = cooked[row];
+
+#ifdef HLC_DEBOUNCE_SYM_DEFER
+        // A key counts while its input differs from the reported state, bouncing back restarts it
+        matrix_row_t active = raw[row] ^ cooked[row];
+#else
+        // Locked keys count regardless of the input, released keys count while they stay released
+        matrix_row_t active = locked[row] | (cooked[row] & ~raw[row]);
+#endif
+
+        // A counter starts at zero, only the ones that were already running get the time since the last call
+        matrix_row_t counted = active & running[row];
+        counter_clear(planes, ~counted);
+
+        matrix_row_t done = counted & counter_done(planes);
+        for (fast_timer_t tick = 0; tick < elapsed; tick++) {
+            counter_increment(planes, counted & ~done);
+            done = counted & counter_done(planes);
+        }
+        counter_clear(planes, done);
+
+#ifdef HLC_DEBOUNCE_SYM_DEFER
+        cooked[row] ^= done;
+        running[row] = raw[row] ^ cooked[row];
+#else
+        // Expired locks just end, expired releases are reported
+        cooked[row] &= ~(done & ~locked[row]);
+        locked[row] &= ~done;
+
+        // New presses are reported right away and locked
+        matrix_row_t pressed = raw[row] & ~cooked[row] & ~locked[row];
+        cooked[row] |= pressed;
+        locked[row] |= pressed;
+        counter_clear(planes, pressed);
+
+        // A key released while it was locked starts counting its release now
+        running[row] = locked[row] | (cooked[row] & ~raw[row]);
+#endif
+
+        cooked_changed |= cooked[row] != before;
+        still_counting |= running[row] != 0;
+    }
+
+    counting = still_counting;
+    return cooked_changed;
+}
+
+#ifdef HLC_MATRIX_CORE1_SCAN
+// Already debounced on core1
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    if (changed) {
+        memcpy(cooked, raw, num_rows * sizeof(matrix_row_t));
+    }
+    return changed;
+}
+#else
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    return hlc_debounce_rows(raw, cooked, num_rows, changed, timer_read_fast());
+}
+#endif
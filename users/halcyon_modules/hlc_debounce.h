@@ -0,0 +1,9 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "matrix.h"
+#include "timer.h"
+
+bool hlc_debounce_rows(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed, fast_timer_t now);
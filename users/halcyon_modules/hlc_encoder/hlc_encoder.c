@@ -1,8 +1,18 @@
 // Copyright 2024 splitkb.com (support@splitkb.com)
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "hlc_encoder.h"
 #include "split_util.h"
 #include "atomic_util.h"
+#include "timer.h"
+#include "debug.h"
+#ifdef HLC_MATRIX_CORE1_SCAN
+#    define HLC_RING_SIZE HLC_SCAN_EVENTS
+#    include "hlc_core1.h"
+#    include "hlc_ring.h"
+#    include "hlc_debounce.h"
+#    include "print.h"
+#endif
 
 #ifdef SPLIT_KEYBOARD
 #    define ROWS_PER_HAND (MATRIX_ROWS / 2)
@@ -36,6 +46,316 @@ static SPLIT_MUTABLE_COL pin_t col_pins[MATRIX_COLS]   = MATRIX_COL_PINS;
 #    endif // MATRIX_COL_PINS
 #endif
 
+#ifdef HLC_MATRIX_CORE1_SCAN
+// Core1 keeps scanning while core0 writes the flash, so everything the scan loop runs is in RAM or inlined into it.
+// It doesn't call into QMK, ChibiOS or libgcc (divisions, __builtin_ctz() on the M0+), the time comes straight from
+// the 1 MHz hardware timer that either core can read.
+static inline __attribute__((always_inline)) uint32_t core1_time_us(void) {
+    return TIMER->TIMERAWL;
+}
+
+// Waits at least us
+static inline __attribute__((always_inline)) void core1_delay_us(uint32_t us) {
+    uint32_t start = core1_time_us();
+
+    while (core1_time_us() - start <= us) {
+    }
+}
+#endif
+
+#ifdef HLC_MATRIX_PORT_SCAN
+#    ifndef MCU_RP
+#        error "HLC_MATRIX_PORT_SCAN reads the RP2040 SIO registers"
+#    endif
+#    if defined(DIRECT_PINS) || (DIODE_DIRECTION != COL2ROW)
+#        error "HLC_MATRIX_PORT_SCAN only supports COL2ROW matrices"
+#    endif
+
+static uint8_t      col_shifts[MATRIX_COLS];   // GPIO number of every column
+static int8_t       col_base = -1;             // First GPIO when the columns are consecutive pins in order, -1 otherwise
+static matrix_row_t row_cols[ROWS_PER_HAND];   // Columns that are wired (and not masked) on every row
+static uint32_t     row_masks[ROWS_PER_HAND];  // SIO bit of every row pin
+
+// Builds the pin tables once, the row pins keep their pull-up and only the output enable (or level) is switched while scanning
+static void port_scan_init(void) {
+    matrix_row_t wired    = 0;
+    uint32_t     all_rows = 0;
+
+    col_base = PAL_PAD(col_pins[0]);
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (col_pins[col] == NO_PIN) {
+            col_base = -1;
+            continue;
+        }
+        col_shifts[col] = PAL_PAD(col_pins[col]);
+        wired |= MATRIX_ROW_SHIFTER << col;
+        if (col_shifts[col] != col_base + col) {
+            col_base = -1;
+        }
+    }
+
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        row_masks[row] = (row_pins[row] != NO_PIN) ? 1UL << PAL_PAD(row_pins[row]) : 0;
+        row_cols[row]  = wired;
+#    ifdef MATRIX_MASKED
+        row_cols[row] &= matrix_mask[row + (isLeftHand ? 0 : ROWS_PER_HAND)];
+#    endif
+        all_rows |= row_masks[row];
+    }
+
+#    ifdef MATRIX_UNSELECT_DRIVE_HIGH
+    SIO->GPIO_OUT_SET = all_rows;
+    SIO->GPIO_OE_SET  = all_rows;
+#    else
+    SIO->GPIO_OUT_CLR = all_rows;
+#    endif
+}
+
+#    ifdef HLC_MATRIX_CORE1_SCAN
+// matrix_output_select_delay() is in flash, the GPIO_INPUT_PIN_DELAY it waits is well below a µs
+#        define port_select_delay() core1_delay_us(1)
+#    else
+#        define port_select_delay() matrix_output_select_delay()
+#    endif
+
+// Single register writes, the SIO set/clear registers don't need a critical section
+static inline __attribute__((always_inline)) void port_select_row(uint8_t row) {
+#    ifdef MATRIX_UNSELECT_DRIVE_HIGH
+    SIO->GPIO_OUT_CLR = row_masks[row];
+#    else
+    SIO->GPIO_OE_SET = row_masks[row];
+#    endif
+}
+
+static inline __attribute__((always_inline)) void port_unselect_row(uint8_t row) {
+#    ifdef MATRIX_UNSELECT_DRIVE_HIGH
+    SIO->GPIO_OUT_SET = row_masks[row];
+#    else
+    SIO->GPIO_OE_CLR = row_masks[row];
+#    endif
+}
+
+// All columns from one read of the input register
+static inline __attribute__((always_inline)) matrix_row_t port_read_cols(uint8_t row, uint32_t port) {
+#    if MATRIX_INPUT_PRESSED_STATE == 0
+    port = ~port;
+#    endif
+
+    if (col_base >= 0) {
+        return (matrix_row_t)(port >> col_base) & row_cols[row];
+    }
+
+    // Every column, unwired ones are masked afterwards
+    matrix_row_t value = 0;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        value |= (matrix_row_t)((port >> col_shifts[col]) & 1) << col;
+    }
+    return value & row_cols[row];
+}
+
+// Reads one row, the caller waits for the columns to settle afterwards
+static inline __attribute__((always_inline)) matrix_row_t port_scan_row(uint8_t row) {
+    matrix_row_t value;
+    uint32_t     port;
+
+    port_select_row(row);
+    port_select_delay();
+    port = SIO->GPIO_IN;
+
+    if (row == (ROWS_PER_HAND - 1)) {
+        value = !((port >> PAL_PAD(HLC_ENCODER_BUTTON)) & 1);
+    } else {
+        value = port_read_cols(row, port);
+    }
+
+    port_unselect_row(row);
+    return value;
+}
+#endif
+
+#ifdef HLC_MATRIX_CORE1_SCAN
+#    ifndef HLC_MATRIX_PORT_SCAN
+#        error "HLC_MATRIX_CORE1_SCAN needs HLC_MATRIX_PORT_SCAN"
+#    endif
+#    ifndef MATRIX_IO_DELAY
+#        define MATRIX_IO_DELAY 30
+#    endif
+
+_Static_assert(ROWS_PER_HAND <= 8 && MATRIX_COLS <= 16, "Key events store the row in 3 bits and the column in 4 bits");
+
+// Key event: the key in the type, the scan start (µs) in the value
+#    define EVENT_TYPE(row, col, pressed) (((pressed) ? 0x80 : 0) | (row) << 4 | (col))
+#    define EVENT_ROW(type) (((type) >> 4) & 0x07)
+#    define EVENT_COL(type) ((type)&0x0F)
+#    define EVENT_PRESSED(type) ((type)&0x80)
+
+static hlc_ring_t       scan_events;
+static matrix_row_t     core0_matrix[ROWS_PER_HAND]; // Debounced keys as far as core0 has seen the events
+static hlc_scan_stats_t scan_stats;
+
+// Core1's matrix state, not on its stack so the scan doesn't start with a memset() from flash
+static matrix_row_t core1_raw[ROWS_PER_HAND];
+static matrix_row_t core1_cooked[ROWS_PER_HAND];
+static matrix_row_t core1_published[ROWS_PER_HAND];
+#endif
+
+static uint32_t scan_count = 0;
+static uint32_t scan_rate  = 0;
+static uint32_t scan_timer = 0;
+
+// Full matrix scans per second, measured over the last second
+uint32_t hlc_matrix_scan_rate(void) {
+    return scan_rate;
+}
+
+#ifdef HLC_MATRIX_CORE1_SCAN
+// Queues the keys whose debounced state changed, a full ring leaves the rest for the next scan
+static inline __attribute__((always_inline)) void publish_events(const matrix_row_t cooked[], matrix_row_t published[], uint32_t timestamp) {
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_row_t changes = cooked[row] ^ published[row];
+
+        for (uint8_t col = 0; changes; col++) {
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            if (!(changes & bit)) {
+                continue;
+            }
+
+            hlc_msg_t msg = {.type = EVENT_TYPE(row, col, cooked[row] & bit), .value = timestamp};
+            if (!hlc_ring_push(&scan_events, &msg)) {
+                scan_stats.ring_full++;
+                return;
+            }
+            published[row] ^= bit;
+            changes &= ~bit;
+        }
+    }
+}
+
+// Scans and debounces at a fixed rate, nothing else runs on core1
+static void __not_in_flash_func(scan_core1_main)(void) {
+    uint32_t slot     = core1_time_us();
+    uint32_t last     = slot;
+    uint32_t clock_ms = 0;
+    uint32_t clock_us = 0; // Remainder of clock_ms
+
+    for (;;) {
+        uint32_t now = core1_time_us();
+        while ((int32_t)(now - slot) < 0) {
+            now = core1_time_us();
+        }
+
+        uint32_t late = now - slot;
+        if (late >= HLC_SCAN_INTERVAL_US) {
+            scan_stats.overruns++;
+            slot = now;
+        }
+        slot += HLC_SCAN_INTERVAL_US;
+        scan_stats.jitter_total_us += late;
+        if (late > scan_stats.jitter_max_us) {
+            scan_stats.jitter_max_us = late;
+        }
+
+        // Millisecond clock for the debounce counters, a scan is less than a millisecond so this hardly loops
+        clock_us += now - last;
+        last = now;
+        while (clock_us >= 1000) {
+            clock_us -= 1000;
+            clock_ms++;
+        }
+
+        bool changed = false;
+        for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+            matrix_row_t value = port_scan_row(row);
+            core1_delay_us(MATRIX_IO_DELAY); // wait for all Col signals to go HIGH
+
+            changed |= value != core1_raw[row];
+            core1_raw[row] = value;
+        }
+
+        hlc_debounce_rows(core1_raw, core1_cooked, ROWS_PER_HAND, changed, clock_ms);
+        publish_events(core1_cooked, core1_published, now);
+
+        scan_stats.scans++;
+        scan_count++;
+        if (now - scan_timer >= 1000000) {
+            scan_rate  = scan_count;
+            scan_count = 0;
+            scan_timer = now;
+        }
+    }
+}
+
+#    ifdef HLC_SCAN_BENCH
+static void report_scan_stats(void) {
+    static uint32_t last_report = 0;
+
+    if (timer_elapsed32(last_report) < HLC_SCAN_BENCH_PERIOD * 1000) {
+        return;
+    }
+    last_report = timer_read32();
+
+    // Core1 keeps counting meanwhile, a report can be off by a scan
+    uint32_t scans  = scan_stats.scans;
+    uint32_t events = scan_stats.events;
+    uprintf("hlc_encoder: %lu scans/s, start jitter %lu us avg %lu us max, %lu overruns, %lu ring full\n", scan_rate, scans ? scan_stats.jitter_total_us / scans : 0, scan_stats.jitter_max_us, scan_stats.overruns, scan_stats.ring_full);
+    uprintf("hlc_encoder: %lu events, latency %lu us avg %lu us max\n", events, events ? scan_stats.latency_total_us / events : 0, scan_stats.latency_max_us);
+}
+#    endif
+
+// Applies the queued events to core0_matrix. A key is only changed once per call, so a tap that got queued whole
+// still reaches QMK as a press and a release.
+static void drain_events(void) {
+    matrix_row_t touched[ROWS_PER_HAND] = {0};
+    hlc_msg_t    msg;
+
+    while (hlc_ring_peek(&scan_events, &msg)) {
+        uint8_t      row = EVENT_ROW(msg.type);
+        matrix_row_t bit = (matrix_row_t)1 << EVENT_COL(msg.type);
+
+        if (touched[row] & bit) {
+            break;
+        }
+        touched[row] |= bit;
+        hlc_ring_pop(&scan_events, &msg);
+
+        if (EVENT_PRESSED(msg.type)) {
+            core0_matrix[row] |= bit;
+        } else {
+            core0_matrix[row] &= ~bit;
+        }
+
+        uint32_t latency = core1_time_us() - msg.value;
+        scan_stats.events++;
+        scan_stats.latency_total_us += latency;
+        if (latency > scan_stats.latency_max_us) {
+            scan_stats.latency_max_us = latency;
+        }
+    }
+
+#    ifdef HLC_SCAN_BENCH
+    report_scan_stats();
+#    endif
+}
+
+const hlc_scan_stats_t *hlc_scan_get_stats(void) {
+    return &scan_stats;
+}
+#endif
+
+#ifndef HLC_MATRIX_CORE1_SCAN
+static void count_scan(void) {
+    scan_count++;
+    if (timer_elapsed32(scan_timer) >= 1000) {
+        scan_rate  = scan_count;
+        scan_count = 0;
+        scan_timer = timer_read32();
+        if (debug_matrix) {
+            dprintf("hlc_encoder: %lu scans/s\n", scan_rate);
+        }
+    }
+}
+#endif
+
 void matrix_init_kb(void) {
 
     gpio_set_pin_input_high(HLC_ENCODER_BUTTON);
@@ -55,6 +375,14 @@ void matrix_init_kb(void) {
                 }
         #    endif
     }
+
+#ifdef HLC_MATRIX_PORT_SCAN
+    port_scan_init();
+#endif
+#ifdef HLC_MATRIX_CORE1_SCAN
+    // From here on core1 owns the row and column pins
+    hlc_core1_launch(scan_core1_main, true);
+#endif
 }
 
 static inline void setPinOutput_writeLow(pin_t pin) {
@@ -85,6 +413,7 @@ static inline uint8_t readMatrixPin(pin_t pin) {
     }
 }
 
+#ifndef HLC_MATRIX_PORT_SCAN
 // THIS FUNCTION IS CHANGED, removed NO_PIN check
 static bool select_row(uint8_t row) {
     pin_t pin = row_pins[row];
@@ -102,11 +431,39 @@ static void unselect_row(uint8_t row) {
 #            endif
     }
 }
+#endif
+
+#if defined(HLC_MATRIX_CORE1_SCAN)
+// QMK's scan only picks up what core1 found, the keys are debounced already
+void matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
+    if (current_row == 0) {
+        drain_events();
+    }
+
+    current_matrix[current_row] = core0_matrix[current_row];
+}
+#elif defined(HLC_MATRIX_PORT_SCAN)
+void matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
+    matrix_row_t current_row_value;
+
+    if (current_row == 0) {
+        count_scan();
+    }
+
+    current_row_value = port_scan_row(current_row);
+    matrix_output_unselect_delay(current_row, current_row_value != 0); // wait for all Col signals to go HIGH
 
+    current_matrix[current_row] = current_row_value;
+}
+#else
 void matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
     // Start with a clear matrix row
     matrix_row_t current_row_value = 0;
 
+    if (current_row == 0) {
+        count_scan();
+    }
+
     if (!select_row(current_row)) { // Select row
         return;                     // skip NO_PIN row
     }
@@ -134,3 +491,4 @@ void matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     // Update the matrix
     current_matrix[current_row] = current_row_value;
 }
+#endif
@@ -0,0 +1,35 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+// Time between the start of two scans on core1 (HLC_MATRIX_CORE1_SCAN)
+#ifndef HLC_SCAN_INTERVAL_US
+#    define HLC_SCAN_INTERVAL_US 250
+#endif
+
+// Key events waiting for core0, a power of two
+#ifndef HLC_SCAN_EVENTS
+#    define HLC_SCAN_EVENTS 64
+#endif
+
+// Seconds between two reports of HLC_SCAN_BENCH on the console
+#ifndef HLC_SCAN_BENCH_PERIOD
+#    define HLC_SCAN_BENCH_PERIOD 10
+#endif
+
+typedef struct {
+    uint32_t scans;            // Scans done by core1
+    uint32_t overruns;         // Scans that started a whole interval late, the missed slots are skipped
+    uint32_t jitter_max_us;    // Latest start of a scan after its slot, the timestamps of its events are off by as much
+    uint32_t jitter_total_us;  // Sum over all scans, for the average
+    uint32_t ring_full;        // Scans that couldn't queue all their events, the rest follows with the next scan
+    uint32_t events;           // Key events handled by core0
+    uint32_t latency_max_us;   // Longest time from the event timestamp until core0 picked it up
+    uint32_t latency_total_us; // Sum over all events, for the average
+} hlc_scan_stats_t;
+
+uint32_t hlc_matrix_scan_rate(void);
+const hlc_scan_stats_t *hlc_scan_get_stats(void);
@@ -2,3 +2,29 @@ CURRENT_DIR := $(dir $(realpath $(lastword $(MAKEFILE_LIST))))
 
 SRC += $(CURRENT_DIR)/hlc_encoder.c
 CONFIG_H += $(CURRENT_DIR)/config.h
+
+# Reads all column pins with a single GPIO register read and switches rows with the SIO set/clear registers.
+# Only checked against the pin scan on the host so far (tests/port_scan_test.c), off until it has run on a board.
+HLC_MATRIX_PORT_SCAN ?= no
+
+ifeq ($(strip $(HLC_MATRIX_PORT_SCAN)), yes)
+    OPT_DEFS += -DHLC_MATRIX_PORT_SCAN
+endif
+
+# Scan and debounce on the second RP2040 core at a fixed rate, QMK picks the debounced keys up as timestamped events.
+# Uses the bit-parallel debounce (DEBOUNCE_TYPE = custom). The scan runs from RAM and goes on while the EEPROM is written.
+# HLC_SCAN_BENCH = yes reports the scan timing on the console.
+HLC_MATRIX_CORE1_SCAN ?= no
+HLC_SCAN_BENCH ?= no
+
+ifeq ($(strip $(HLC_MATRIX_CORE1_SCAN)), yes)
+    ifneq ($(strip $(HLC_MATRIX_PORT_SCAN)), yes)
+        $(error HLC_MATRIX_CORE1_SCAN requires HLC_MATRIX_PORT_SCAN = yes)
+    endif
+    OPT_DEFS += -DHLC_MATRIX_CORE1_SCAN
+    DEBOUNCE_TYPE = custom
+    HLC_CORE1 = yes
+    ifeq ($(strip $(HLC_SCAN_BENCH)), yes)
+        OPT_DEFS += -DHLC_SCAN_BENCH
+    endif
+endif
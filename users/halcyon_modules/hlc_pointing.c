@@ -0,0 +1,242 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Pointer processing in Q16.16 fixed point for the combined pointing reports, no float math per report.
+//
+// Smoothing (HLC_POINTING_SMOOTH) is a 1€ filter: a low-pass whose cutoff rises with the pointer speed, so the
+// jitter of a resting or slowly moving finger is filtered out while fast movement passes with little lag. The
+// reports are deltas, so the filter keeps the distance between the position it was sent and the filtered one.
+//
+// Acceleration (HLC_POINTING_ACCEL) scales the motion by a gain that depends on the pointer velocity v (counts/ms),
+// following the curve of the maccel community module:
+//
+//     gain(v) = limit - (limit - 1) / (1 + e^(takeoff * (v - offset)))^(growth_rate / takeoff)
+//
+// It starts at 1 for slow movement, rises around v = offset and levels off at limit. growth_rate sets how fast it
+// rises and takeoff how sharp the bend at offset is. The curve is sampled into a table once per configuration, a
+// report then costs an approximate vector length, a table lookup and two multiplies.
+// What's left after rounding the scaled motion down to whole counts is carried over to the next report.
+
+#include "hlc_pointing.h"
+#include "pointing_device.h"
+#include "timer.h"
+
+#ifdef HLC_POINTING_ACCEL
+#    include <math.h>
+#endif
+
+// Longest report interval used for the velocity, anything slower counts as resting
+#define DT_MAX 255
+
+#ifdef MOUSE_EXTENDED_REPORT
+typedef int64_t accel_acc_t;
+#else
+typedef int32_t accel_acc_t;
+#endif
+
+// Measures the time since the last report, true when it differs from the previous interval
+static bool report_interval(hlc_report_interval_t *interval) {
+    uint16_t now = timer_read();
+    uint16_t dt  = TIMER_DIFF_16(now, interval->last_time);
+
+    interval->last_time = now;
+    if (dt == 0) {
+        dt = 1;
+    } else if (dt > DT_MAX) {
+        dt = DT_MAX;
+    }
+    // The reciprocal only changes with the report rate, so this divides once in a while instead of every report
+    if (dt == interval->last_dt) {
+        return false;
+    }
+    interval->last_dt = dt;
+    interval->inv_dt  = 65536 / dt;
+    return true;
+}
+
+// Length of (x, y) as max + 3/8 min, within 7% of the real one
+static inline uint32_t approx_length(int32_t x, int32_t y) {
+    uint32_t ax = x < 0 ? -x : x;
+    uint32_t ay = y < 0 ? -y : y;
+    return ax > ay ? ax + ((ay * 3) >> 3) : ay + ((ax * 3) >> 3);
+}
+
+static inline mouse_xy_report_t clamp_xy(accel_acc_t value) {
+    if (value > XY_REPORT_MAX) {
+        return XY_REPORT_MAX;
+    }
+    if (value < XY_REPORT_MIN) {
+        return XY_REPORT_MIN;
+    }
+    return (mouse_xy_report_t)value;
+}
+
+#ifdef HLC_POINTING_SMOOTH
+// 2 pi / 1000 in Q24, turns Hz * ms into radians
+#    define TWO_PI_MS_Q24 105414
+
+#    define SMOOTH_MIN_CUTOFF ((int32_t)(HLC_SMOOTH_MIN_CUTOFF * 65536))
+#    define SMOOTH_BETA ((int32_t)(HLC_SMOOTH_BETA * 65536))
+#    define SMOOTH_D_CUTOFF ((int32_t)(HLC_SMOOTH_D_CUTOFF * 65536))
+
+// Smoothed speed (Q16.16 counts/ms) below which a source without motion is at rest, a count per second
+#    define SMOOTH_REST_SPEED 66
+
+static inline int32_t mul_q16(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a * b) >> 16);
+}
+
+// Q16.16 smoothing factor of a low-pass with a cutoff (Q16.16 Hz) sampled every dt ms: r / (1 + r), r = 2 pi cutoff dt
+static uint32_t smoothing_factor(int32_t cutoff, uint16_t dt) {
+    uint32_t r = (uint32_t)mul_q16(cutoff, (dt * TWO_PI_MS_Q24) >> 8);
+    return 65536 - 0xFFFFFFFF / (65536 + r);
+}
+
+// Q16.16 counts/ms, kept far enough from the int32 limits to subtract the smoothed speed
+static inline int32_t smooth_velocity(mouse_xy_report_t value, uint32_t inv_dt) {
+    int32_t velocity = value * (int32_t)inv_dt;
+#    ifdef MOUSE_EXTENDED_REPORT
+    if (velocity > (1 << 29)) {
+        velocity = 1 << 29;
+    } else if (velocity < -(1 << 29)) {
+        velocity = -(1 << 29);
+    }
+#    endif
+    return velocity;
+}
+
+// Moves the filtered position towards the received one. lag is the distance between the two, rem the fraction of
+// the filtered movement that wasn't sent yet. The movement is rounded to the nearest count, rounding it down would
+// keep the pointer up to a count behind even without any smoothing.
+static inline mouse_xy_report_t smooth_axis(mouse_xy_report_t value, uint32_t alpha, int32_t *lag, int32_t *rem) {
+    accel_acc_t pending = (accel_acc_t)value * 65536 + *lag;
+    accel_acc_t move    = (accel_acc_t)(((int64_t)pending * alpha) >> 16);
+    accel_acc_t total   = move + *rem;
+
+    mouse_xy_report_t whole = clamp_xy((total + (total < 0 ? -32768 : 32768)) / 65536);
+    pending -= move;
+    total -= (accel_acc_t)whole * 65536;
+
+    // Only a pointer that is way behind gets here, dropping some of that doesn't show
+    if (pending > INT32_MAX / 2) {
+        pending = INT32_MAX / 2;
+    } else if (pending < -(INT32_MAX / 2)) {
+        pending = -(INT32_MAX / 2);
+    }
+    if (total > INT32_MAX / 2) {
+        total = INT32_MAX / 2;
+    } else if (total < -(INT32_MAX / 2)) {
+        total = -(INT32_MAX / 2);
+    }
+    *lag = (int32_t)pending;
+    *rem = (int32_t)total;
+    return whole;
+}
+
+report_mouse_t hlc_smooth_apply(hlc_smooth_state_t *state, report_mouse_t report) {
+    if (report_interval(&state->interval)) {
+        state->alpha_d = smoothing_factor(SMOOTH_D_CUTOFF, state->interval.last_dt);
+    }
+    // Once the pointer has come to rest less than a count behind, the rest is dropped and the filter starts over
+    if (report.x == 0 && report.y == 0 && approx_length(state->lag_x, state->lag_y) < 65536 && approx_length(state->speed_x, state->speed_y) < SMOOTH_REST_SPEED) {
+        *state = (hlc_smooth_state_t){.interval = state->interval, .alpha_d = state->alpha_d};
+        return report;
+    }
+
+    int32_t velocity_x = smooth_velocity(report.x, state->interval.inv_dt);
+    int32_t velocity_y = smooth_velocity(report.y, state->interval.inv_dt);
+    state->speed_x += mul_q16(velocity_x - state->speed_x, state->alpha_d);
+    state->speed_y += mul_q16(velocity_y - state->speed_y, state->alpha_d);
+
+    int32_t  cutoff = SMOOTH_MIN_CUTOFF + mul_q16(SMOOTH_BETA, approx_length(state->speed_x, state->speed_y));
+    uint32_t alpha  = smoothing_factor(cutoff, state->interval.last_dt);
+
+    report.x = smooth_axis(report.x, alpha, &state->lag_x, &state->rem_x);
+    report.y = smooth_axis(report.y, alpha, &state->lag_y, &state->rem_y);
+    return report;
+}
+#endif
+
+#ifdef HLC_POINTING_ACCEL
+// Gains above this are clamped, keeps count * gain within 32 bits for 8 bit reports
+#    define GAIN_MAX ((int32_t)127 << 16)
+
+_Static_assert(HLC_ACCEL_LUT_SHIFT >= 8 && HLC_ACCEL_LUT_SHIFT <= 16, "HLC_ACCEL_LUT_SHIFT has to be 8 to 16");
+
+static int32_t gain_lut[HLC_ACCEL_LUT_SIZE + 1]; // Q16.16, the extra entry ends the last interpolation step
+static bool    accel_enabled = false;
+
+void hlc_accel_configure(const hlc_accel_config_t *config) {
+    float takeoff = config->takeoff > 0.01f ? config->takeoff : 0.01f;
+    float power   = config->growth_rate / takeoff;
+    float limit   = config->limit;
+
+    for (uint16_t i = 0; i <= HLC_ACCEL_LUT_SIZE; i++) {
+        float v    = (float)i * (float)(1 << HLC_ACCEL_LUT_SHIFT) / 65536.0f;
+        float gain = limit - (limit - 1.0f) / powf(1.0f + expf(takeoff * (v - config->offset)), power);
+
+        if (!(gain > 0.0f)) { // Also catches NaN
+            gain = 0.0f;
+        }
+        int32_t fixed = (int32_t)lroundf(fminf(gain * 65536.0f, (float)GAIN_MAX));
+        gain_lut[i]   = fixed;
+    }
+    accel_enabled = config->enabled;
+}
+
+void hlc_accel_init(void) {
+    hlc_accel_config_t config = {
+        .enabled     = true,
+        .growth_rate = HLC_ACCEL_GROWTH_RATE,
+        .offset      = HLC_ACCEL_OFFSET,
+        .limit       = HLC_ACCEL_LIMIT,
+        .takeoff     = HLC_ACCEL_TAKEOFF,
+    };
+    hlc_accel_configure(&config);
+}
+
+// Q16.16 gain for a Q16.16 velocity, linear between the table entries
+static inline int32_t accel_gain(uint32_t velocity) {
+    uint32_t index = velocity >> HLC_ACCEL_LUT_SHIFT;
+
+    if (index >= HLC_ACCEL_LUT_SIZE) {
+        return gain_lut[HLC_ACCEL_LUT_SIZE];
+    }
+    int32_t frac = (velocity >> (HLC_ACCEL_LUT_SHIFT - 8)) & 0xFF;
+    int32_t low  = gain_lut[index];
+    return low + (((gain_lut[index + 1] - low) * frac) >> 8);
+}
+
+// Scales one axis, rem keeps the fraction that didn't make a whole count
+static inline mouse_xy_report_t accel_axis(mouse_xy_report_t value, int32_t gain, int32_t *rem) {
+    if (value == 0) {
+        return 0;
+    }
+    // A fraction left over from the other direction would only hold the pointer back
+    if ((value < 0) != (*rem < 0)) {
+        *rem = 0;
+    }
+
+    accel_acc_t scaled = (accel_acc_t)value * gain + *rem;
+    accel_acc_t whole  = scaled / 65536; // Towards zero, rem keeps the sign of the motion
+    *rem               = (int32_t)(scaled - whole * 65536);
+    return clamp_xy(whole);
+}
+
+report_mouse_t hlc_accel_apply(hlc_accel_state_t *state, report_mouse_t report) {
+    report_interval(&state->interval);
+    if (!accel_enabled || (report.x == 0 && report.y == 0)) {
+        return report;
+    }
+
+    uint32_t len = approx_length(report.x, report.y);
+    if (len > UINT16_MAX) {
+        len = UINT16_MAX;
+    }
+
+    int32_t gain = accel_gain(len * state->interval.inv_dt);
+    report.x     = accel_axis(report.x, gain, &state->rem_x);
+    report.y     = accel_axis(report.y, gain, &state->rem_y);
+    return report;
+}
+#endif
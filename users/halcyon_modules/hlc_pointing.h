@@ -0,0 +1,83 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "report.h"
+
+// Curve used until hlc_accel_configure() is called, see hlc_pointing.c for what the parameters do
+#ifndef HLC_ACCEL_TAKEOFF
+#    define HLC_ACCEL_TAKEOFF 2.0f
+#endif
+#ifndef HLC_ACCEL_GROWTH_RATE
+#    define HLC_ACCEL_GROWTH_RATE 0.25f
+#endif
+#ifndef HLC_ACCEL_OFFSET
+#    define HLC_ACCEL_OFFSET 2.2f
+#endif
+#ifndef HLC_ACCEL_LIMIT
+#    define HLC_ACCEL_LIMIT 4.0f
+#endif
+
+// Gain table entries, one every 2^-(16 - HLC_ACCEL_LUT_SHIFT) counts/ms. The default covers 0 to 16 counts/ms,
+// faster movement gets the gain of the last entry.
+#ifndef HLC_ACCEL_LUT_SIZE
+#    define HLC_ACCEL_LUT_SIZE 64
+#endif
+#ifndef HLC_ACCEL_LUT_SHIFT
+#    define HLC_ACCEL_LUT_SHIFT 14
+#endif
+
+// 1€ filter (HLC_POINTING_SMOOTH): the cutoff frequency is HLC_SMOOTH_MIN_CUTOFF Hz while the pointer rests and grows
+// by HLC_SMOOTH_BETA Hz per count/ms of speed, the speed itself is smoothed with HLC_SMOOTH_D_CUTOFF Hz
+#ifndef HLC_SMOOTH_MIN_CUTOFF
+#    define HLC_SMOOTH_MIN_CUTOFF 1.0
+#endif
+#ifndef HLC_SMOOTH_BETA
+#    define HLC_SMOOTH_BETA 100.0
+#endif
+#ifndef HLC_SMOOTH_D_CUTOFF
+#    define HLC_SMOOTH_D_CUTOFF 20.0
+#endif
+
+// Time between two reports of one source
+typedef struct {
+    uint16_t last_time;
+    uint16_t last_dt;
+    uint32_t inv_dt; // Q16.16 of 1 / last_dt
+} hlc_report_interval_t;
+
+// Same fields as userspace_config.pointing.accel in the default_hlc keymap, which loads them from its user EEPROM block
+typedef struct {
+    bool  enabled;
+    float growth_rate;
+    float offset;
+    float limit;
+    float takeoff;
+} hlc_accel_config_t;
+
+// Per report source state, the sub-pixel remainders are kept here
+typedef struct {
+    hlc_report_interval_t interval;
+    int32_t               rem_x; // Q16.16, |rem| < 1
+    int32_t               rem_y;
+} hlc_accel_state_t;
+
+typedef struct {
+    hlc_report_interval_t interval;
+    uint32_t              alpha_d; // Q16.16 smoothing factor of the speed at last_dt
+    int32_t               lag_x;   // Q16.16, motion received but not filtered in yet
+    int32_t               lag_y;
+    int32_t               rem_x;   // Q16.16, filtered motion short of a whole count
+    int32_t               rem_y;
+    int32_t               speed_x; // Q16.16 counts/ms, smoothed
+    int32_t               speed_y;
+} hlc_smooth_state_t;
+
+// Rebuilds the gain table, uses float math so keep it out of the pointing task
+void hlc_accel_configure(const hlc_accel_config_t *config);
+void hlc_accel_init(void);
+report_mouse_t hlc_accel_apply(hlc_accel_state_t *state, report_mouse_t report);
+report_mouse_t hlc_smooth_apply(hlc_smooth_state_t *state, report_mouse_t report);
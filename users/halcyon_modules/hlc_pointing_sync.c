@@ -0,0 +1,255 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Moves the slave's pointing motion to the master in place of SPLIT_POINTING_ENABLE (HLC_POINTING_SYNC).
+// QMK reads the slave's sensor in the split transport and has the master ask for a checksum of it every scan, the
+// report is overwritten on the slave when the master is late. Here the slave adds every report it reads to a set of
+// saturating accumulators, and the master fetches what was collected.
+// Every transaction of our own is a full RPC (four transport transactions), asking the slave whether it has anything
+// would cost about as much as fetching it. Instead the slave measures how often its sensor reports motion and tells
+// the master in every packet when the next report is due: in motion the master fetches then, and every
+// HLC_POINTING_SYNC_MS after that until the report came. While the pointing device is idle, and after every failed
+// transaction in a row, the time until the next fetch doubles up to HLC_POINTING_SYNC_IDLE_MS.
+// A packet holds one report's worth of motion, the rest stays with the slave for the next one.
+// A packet is sent again until the master acknowledges its sequence number, so a failed transaction loses nothing.
+// The master feeds its own and the slave's motion to pointing_device_task_combined_kb() like QMK would.
+
+#include "hlc_pointing_sync.h"
+#include "quantum.h"
+#include "transactions.h"
+#include "split_util.h"
+#include "atomic_util.h"
+#include "timer.h"
+
+#ifdef WHEEL_EXTENDED_REPORT
+#    define HV_MIN INT16_MIN
+#    define HV_MAX INT16_MAX
+#else
+#    define HV_MIN INT8_MIN
+#    define HV_MAX INT8_MAX
+#endif
+
+// Motion that hasn't been passed on yet is capped at this, a pointer that far behind is at the edge of the screen
+#define MOTION_MAX INT16_MAX
+
+typedef struct PACKED {
+    uint8_t ack; // Sequence number of the last packet the master got
+} pointing_sync_request_t;
+
+typedef struct PACKED {
+    uint8_t           sequence;
+    uint8_t           next_ms; // Time until the slave expects its next report, 0 when it doesn't know
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    mouse_hv_report_t h;
+    mouse_hv_report_t v;
+} pointing_sync_packet_t;
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t h;
+    int32_t v;
+} motion_t;
+
+// Slave: motion that isn't in a packet yet, and the last packet until the master has it
+static motion_t               slave_motion;
+static uint8_t                slave_buttons;
+static uint8_t                slave_pressed; // Buttons pressed since the last packet, so a short tap isn't lost
+static pointing_sync_packet_t slave_packet;
+static uint32_t               slave_last_report; // Last report with motion or a button change
+static uint32_t               slave_period;      // Average time between those, 0 after a pause
+
+// Master: motion received from the slave that isn't in a report yet
+static motion_t                  remote_motion;
+static uint8_t                   remote_buttons;
+static uint8_t                   last_sequence;
+static uint32_t                  last_sync;
+static uint32_t                  last_active;
+static uint16_t                  sync_wait = HLC_POINTING_SYNC_IDLE_MS;
+static uint8_t                   failures; // Failed transactions in a row
+static hlc_pointing_sync_stats_t sync_stats;
+
+static inline int32_t add_saturated(int32_t total, int32_t value) {
+    total += value;
+    if (total > MOTION_MAX) {
+        return MOTION_MAX;
+    }
+    if (total < -MOTION_MAX) {
+        return -MOTION_MAX;
+    }
+    return total;
+}
+
+static void motion_add(motion_t *motion, int32_t x, int32_t y, int32_t h, int32_t v) {
+    motion->x = add_saturated(motion->x, x);
+    motion->y = add_saturated(motion->y, y);
+    motion->h = add_saturated(motion->h, h);
+    motion->v = add_saturated(motion->v, v);
+}
+
+// Takes as much of total as fits in [min, max], the rest stays for the next one
+static inline int32_t take(int32_t *total, int32_t min, int32_t max) {
+    int32_t value = *total;
+
+    if (value > max) {
+        value = max;
+    } else if (value < min) {
+        value = min;
+    }
+    *total -= value;
+    return value;
+}
+
+// Time until the next report with motion is due, counted in periods from the last one. A report that was due right
+// now is late, the master asks again in a moment. Sensors also skip reports (no motion), a later one comes a period
+// after.
+static uint8_t next_report_ms(void) {
+    uint32_t since = timer_elapsed32(slave_last_report);
+
+    if (slave_period == 0 || since >= HLC_POINTING_SYNC_HOLD_MS) {
+        return 0;
+    }
+
+    uint32_t phase = since % slave_period;
+    return phase == 0 ? 1 : slave_period - phase;
+}
+
+static void pointing_sync_slave_handler(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    pointing_sync_request_t request;
+
+    if (initiator2target_buffer_size != sizeof(request) || target2initiator_buffer_size < sizeof(slave_packet)) {
+        return;
+    }
+    memcpy(&request, initiator2target_buffer, sizeof(request));
+
+    // Runs in the transport, pointing_device_task_kb() only touches the slave state with interrupts off
+    if (request.ack == slave_packet.sequence) {
+        slave_packet.sequence++;
+        slave_packet.x       = take(&slave_motion.x, XY_REPORT_MIN, XY_REPORT_MAX);
+        slave_packet.y       = take(&slave_motion.y, XY_REPORT_MIN, XY_REPORT_MAX);
+        slave_packet.h       = take(&slave_motion.h, HV_MIN, HV_MAX);
+        slave_packet.v       = take(&slave_motion.v, HV_MIN, HV_MAX);
+        slave_packet.buttons = slave_buttons | slave_pressed;
+        slave_pressed        = 0;
+
+        slave_packet.next_ms = next_report_ms();
+    }
+    memcpy(target2initiator_buffer, &slave_packet, sizeof(slave_packet));
+}
+
+void hlc_pointing_sync_init(void) {
+    transaction_register_rpc(POINTING_SYNC, pointing_sync_slave_handler);
+}
+
+// Master only, one transaction per HLC_POINTING_SYNC_MS at most
+void hlc_pointing_sync_task(void) {
+    if (!is_transport_connected() || timer_elapsed32(last_sync) < sync_wait) {
+        return;
+    }
+    last_sync = timer_read32();
+
+    // Until a packet says otherwise
+    bool idle = timer_elapsed32(last_active) >= HLC_POINTING_SYNC_HOLD_MS;
+    if (idle) {
+        sync_wait = MIN(sync_wait * 2, HLC_POINTING_SYNC_IDLE_MS);
+        sync_stats.idle++;
+    } else {
+        sync_wait = HLC_POINTING_SYNC_MS;
+    }
+
+    pointing_sync_request_t request = {.ack = last_sequence};
+    pointing_sync_packet_t  packet  = {0};
+
+    sync_stats.polls++;
+    if (!transaction_rpc_exec(POINTING_SYNC, sizeof(request), &request, sizeof(packet), &packet)) {
+        // The slave keeps the packet until it's acknowledged, asking again right away would only load a bad link more
+        sync_stats.failed++;
+        failures  = MIN(failures + 1, 4);
+        sync_wait = MIN(sync_wait << failures, HLC_POINTING_SYNC_IDLE_MS);
+        return;
+    }
+    failures = 0;
+    if (packet.sequence == last_sequence) {
+        return; // Already merged
+    }
+    last_sequence = packet.sequence;
+
+    if (packet.x || packet.y || packet.h || packet.v || packet.buttons != remote_buttons) {
+        sync_stats.motion++;
+        last_active = last_sync;
+        idle        = false;
+    } else if (!idle) {
+        sync_stats.early++;
+    }
+    if (!idle && packet.next_ms) {
+        sync_wait = MIN(MAX(packet.next_ms, HLC_POINTING_SYNC_MS), HLC_POINTING_SYNC_HOLD_MS);
+    }
+    motion_add(&remote_motion, packet.x, packet.y, packet.h, packet.v);
+    remote_buttons = packet.buttons;
+}
+
+const hlc_pointing_sync_stats_t *hlc_pointing_sync_get_stats(void) {
+    return &sync_stats;
+}
+
+static report_mouse_t combine_reports(report_mouse_t left_report, report_mouse_t right_report) {
+    motion_t motion = {0};
+
+    motion_add(&motion, left_report.x, left_report.y, left_report.h, left_report.v);
+    motion_add(&motion, right_report.x, right_report.y, right_report.h, right_report.v);
+
+    left_report.buttons |= right_report.buttons;
+    left_report.x = take(&motion.x, XY_REPORT_MIN, XY_REPORT_MAX);
+    left_report.y = take(&motion.y, XY_REPORT_MIN, XY_REPORT_MAX);
+    left_report.h = take(&motion.h, HV_MIN, HV_MAX);
+    left_report.v = take(&motion.v, HV_MIN, HV_MAX);
+    return left_report;
+}
+
+__attribute__((weak)) report_mouse_t pointing_device_task_combined_user(report_mouse_t left_report, report_mouse_t right_report) {
+    return combine_reports(left_report, right_report);
+}
+
+report_mouse_t pointing_device_task_kb(report_mouse_t mouse_report) {
+#ifdef POINTING_DEVICE_ROTATION_180
+    // Meant for a module on the left half, the one on the right half sits the other way around
+    if (!is_keyboard_left()) {
+        mouse_report.x = -mouse_report.x;
+        mouse_report.y = -mouse_report.y;
+    }
+#endif
+
+    if (!is_keyboard_master()) {
+        if (mouse_report.x || mouse_report.y || mouse_report.h || mouse_report.v || mouse_report.buttons != slave_buttons) {
+            uint32_t since = timer_elapsed32(slave_last_report);
+            ATOMIC_BLOCK_FORCEON {
+                slave_period      = since >= HLC_POINTING_SYNC_HOLD_MS ? 0 : slave_period ? (3 * slave_period + since + 2) / 4 : since;
+                slave_last_report = timer_read32();
+            }
+        }
+        ATOMIC_BLOCK_FORCEON {
+            motion_add(&slave_motion, mouse_report.x, mouse_report.y, mouse_report.h, mouse_report.v);
+            slave_pressed |= mouse_report.buttons & ~slave_buttons;
+            slave_buttons = mouse_report.buttons;
+        }
+        // Nothing for the slave to send, the buttons stay for the driver
+        mouse_report.x = 0;
+        mouse_report.y = 0;
+        mouse_report.h = 0;
+        mouse_report.v = 0;
+        return mouse_report;
+    }
+
+    report_mouse_t remote_report = {.buttons = remote_buttons};
+    remote_report.x              = take(&remote_motion.x, XY_REPORT_MIN, XY_REPORT_MAX);
+    remote_report.y              = take(&remote_motion.y, XY_REPORT_MIN, XY_REPORT_MAX);
+    remote_report.h              = take(&remote_motion.h, HV_MIN, HV_MAX);
+    remote_report.v              = take(&remote_motion.v, HV_MIN, HV_MAX);
+
+    if (is_keyboard_left()) {
+        return pointing_device_task_combined_kb(mouse_report, remote_report);
+    }
+    return pointing_device_task_combined_kb(remote_report, mouse_report);
+}
@@ -0,0 +1,49 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include "report.h"
+#include "pointing_device.h"
+
+#ifndef USB_POLLING_INTERVAL_MS
+#    define USB_POLLING_INTERVAL_MS 1
+#endif
+
+// Time between fetches of the slave's motion. The host takes no more than one report per poll interval, and the
+// slave has nothing new between two reads of its sensor.
+#ifndef HLC_POINTING_SYNC_MS
+#    if defined(POINTING_DEVICE_TASK_THROTTLE_MS) && POINTING_DEVICE_TASK_THROTTLE_MS > USB_POLLING_INTERVAL_MS
+#        define HLC_POINTING_SYNC_MS POINTING_DEVICE_TASK_THROTTLE_MS
+#    else
+#        define HLC_POINTING_SYNC_MS USB_POLLING_INTERVAL_MS
+#    endif
+#endif
+
+// Longest time between fetches. An idle pointing device and failed transactions double the time up to this, the first
+// motion after a pause waits up to this long.
+#ifndef HLC_POINTING_SYNC_IDLE_MS
+#    define HLC_POINTING_SYNC_IDLE_MS (16 * HLC_POINTING_SYNC_MS)
+#endif
+
+// The slave's pointing device counts as idle after this long without motion or a button change
+#ifndef HLC_POINTING_SYNC_HOLD_MS
+#    define HLC_POINTING_SYNC_HOLD_MS 50
+#endif
+
+typedef struct {
+    uint32_t polls;  // Transactions sent
+    uint32_t motion; // Packets that carried motion or a button change
+    uint32_t idle;   // Fetches while the pointing device was idle
+    uint32_t early;  // Fetches in motion that came before the slave's next report, it was late
+    uint32_t failed; // Transactions that failed, the slave sends the same packet again
+} hlc_pointing_sync_stats_t;
+
+// QMK only declares and calls these with SPLIT_POINTING_ENABLE, hlc_pointing_sync.c calls them instead
+report_mouse_t pointing_device_task_combined_kb(report_mouse_t left_report, report_mouse_t right_report);
+report_mouse_t pointing_device_task_combined_user(report_mouse_t left_report, report_mouse_t right_report);
+
+void hlc_pointing_sync_init(void);
+void hlc_pointing_sync_task(void);
+const hlc_pointing_sync_stats_t *hlc_pointing_sync_get_stats(void);
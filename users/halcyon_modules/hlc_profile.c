@@ -0,0 +1,65 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_profile.h"
+
+#include "hal.h"
+#include "print.h"
+
+// The Cortex-M0+ has no DWT cycle counter, SysTick is unused by ChibiOS on the RP2040 and counts down at the core clock
+#define SYSTICK_MASK 0xFFFFFF
+
+static const char *const zone_names[HLC_PROFILE_COUNT] = {
+    [HLC_PROFILE_SCAN]      = "scan",
+    [HLC_PROFILE_LOOP]      = "loop",
+    [HLC_PROFILE_DISPLAY]   = "display",
+    [HLC_PROFILE_MODULE]    = "module",
+    [HLC_PROFILE_BACKLIGHT] = "backlight",
+};
+
+static uint32_t histograms[HLC_PROFILE_COUNT][HLC_PROFILE_BUCKETS];
+static uint32_t max_cycles[HLC_PROFILE_COUNT];
+
+void hlc_profile_init(void) {
+    SysTick->LOAD = SYSTICK_MASK;
+    SysTick->VAL  = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+uint32_t hlc_profile_now(void) {
+    return SysTick->VAL;
+}
+
+// Zones longer than 2^24 cycles (134 ms at 125 MHz) wrap around
+void hlc_profile_record(hlc_profile_zone_t zone, uint32_t start) {
+    uint32_t cycles = (start - SysTick->VAL) & SYSTICK_MASK;
+    uint8_t  bucket = cycles ? 32 - __builtin_clz(cycles) : 0;
+
+    histograms[zone][bucket]++;
+    if (cycles > max_cycles[zone]) {
+        max_cycles[zone] = cycles;
+    }
+}
+
+void hlc_profile_reset(void) {
+    for (uint8_t zone = 0; zone < HLC_PROFILE_COUNT; zone++) {
+        for (uint8_t bucket = 0; bucket < HLC_PROFILE_BUCKETS; bucket++) {
+            histograms[zone][bucket] = 0;
+        }
+        max_cycles[zone] = 0;
+    }
+}
+
+// Prints one line per non-empty bucket with its upper bound in cycles, then clears the histograms
+void hlc_profile_dump(void) {
+    uprintf("hlc_profile: durations in core clock cycles\n");
+    for (uint8_t zone = 0; zone < HLC_PROFILE_COUNT; zone++) {
+        uprintf("%s (max %lu)\n", zone_names[zone], max_cycles[zone]);
+        for (uint8_t bucket = 0; bucket < HLC_PROFILE_BUCKETS; bucket++) {
+            if (histograms[zone][bucket]) {
+                uprintf("  < %8lu: %lu\n", 1UL << bucket, histograms[zone][bucket]);
+            }
+        }
+    }
+    hlc_profile_reset();
+}
@@ -0,0 +1,41 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+// Put this keycode in a keymap to print the histograms on the console
+#define HLC_PROFILE_DUMP QK_KB_0
+
+// Bucket n counts durations of n significant bits, [2^(n-1), 2^n) cycles. SysTick is 24 bits wide.
+#define HLC_PROFILE_BUCKETS 25
+
+typedef enum {
+    HLC_PROFILE_SCAN,      // End of housekeeping up to matrix_scan_kb(), the matrix scan and split transport
+    HLC_PROFILE_LOOP,      // A full main loop iteration
+    HLC_PROFILE_DISPLAY,   // display_module_housekeeping_task_kb()
+    HLC_PROFILE_MODULE,    // module_housekeeping_task_kb()
+    HLC_PROFILE_BACKLIGHT, // Backlight timeout handling
+    HLC_PROFILE_COUNT
+} hlc_profile_zone_t;
+
+#ifdef HLC_PROFILE_ENABLE
+#    define HLC_PROFILE(zone, ...)                  \
+        do {                                        \
+            uint32_t _start = hlc_profile_now();    \
+            __VA_ARGS__;                            \
+            hlc_profile_record(zone, _start);       \
+        } while (0)
+#else
+#    define HLC_PROFILE(zone, ...) \
+        do {                       \
+            __VA_ARGS__;           \
+        } while (0)
+#endif
+
+void hlc_profile_init(void);
+uint32_t hlc_profile_now(void);
+void hlc_profile_record(hlc_profile_zone_t zone, uint32_t start);
+void hlc_profile_reset(void);
+void hlc_profile_dump(void);
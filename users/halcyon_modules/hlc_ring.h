@@ -0,0 +1,66 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Messages queued from one core to the other
+#ifndef HLC_RING_SIZE
+#    define HLC_RING_SIZE 16
+#endif
+
+_Static_assert((HLC_RING_SIZE & (HLC_RING_SIZE - 1)) == 0, "HLC_RING_SIZE must be a power of two");
+
+typedef struct {
+    uint8_t  type;
+    uint32_t value;
+} hlc_msg_t;
+
+// Single producer, single consumer without locks: only the producer writes head and only the consumer writes tail.
+// Both are free running counters, the difference is the amount of queued messages.
+// The functions are always inlined, so code running from RAM can use them.
+typedef struct {
+    hlc_msg_t   msgs[HLC_RING_SIZE];
+    atomic_uint head; // Next slot to write
+    atomic_uint tail; // Next slot to read
+} hlc_ring_t;
+
+// Producer side, returns false when the ring is full
+static inline __attribute__((always_inline)) bool hlc_ring_push(hlc_ring_t *ring, const hlc_msg_t *msg) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) >= HLC_RING_SIZE) {
+        return false;
+    }
+    ring->msgs[head % HLC_RING_SIZE] = *msg;
+    // The message is written before the consumer can see the new head
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Consumer side, looks at the oldest message without taking it
+static inline __attribute__((always_inline)) bool hlc_ring_peek(hlc_ring_t *ring, hlc_msg_t *msg) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail == atomic_load_explicit(&ring->head, memory_order_acquire)) {
+        return false;
+    }
+    *msg = ring->msgs[tail % HLC_RING_SIZE];
+    return true;
+}
+
+// Consumer side, returns false when the ring is empty
+static inline __attribute__((always_inline)) bool hlc_ring_pop(hlc_ring_t *ring, hlc_msg_t *msg) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail == atomic_load_explicit(&ring->head, memory_order_acquire)) {
+        return false;
+    }
+    *msg = ring->msgs[tail % HLC_RING_SIZE];
+    // The slot is read before the producer can reuse it
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
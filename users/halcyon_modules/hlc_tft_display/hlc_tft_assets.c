@@ -0,0 +1,72 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_assets.h"
+
+#include <string.h>
+#include "util.h"
+
+#ifdef HLC_TFT_ASSET_BUNDLE
+static inline void fill_span(hlc_pixel_t *pixel, hlc_pixel_t color, uint16_t count) {
+    while (count--) {
+        *pixel++ = color;
+    }
+}
+
+// Decodes the runs straight into the canvas, rows outside of it are only skipped over
+void hlc_asset_blit(const hlc_canvas_t *canvas, const hlc_asset_t *asset, uint16_t x, uint16_t y) {
+    if (x >= canvas->width || y >= canvas->top + canvas->height || y + asset->height <= canvas->top) {
+        return;
+    }
+
+    const uint8_t *runs      = asset->runs;
+    hlc_pixel_t    colors[2] = {hlc_palette[hlc_asset_palettes[asset->palette][1]], hlc_palette[hlc_asset_palettes[asset->palette][0]]};
+    uint16_t       first     = MAX(y, canvas->top) - y; // Rows of the asset
+    uint16_t       last      = MIN(y + asset->height, canvas->top + canvas->height) - y;
+    uint16_t       width     = MIN(asset->width, canvas->width - x);
+    uint16_t       row       = 0;
+    uint16_t       column    = 0;
+    uint8_t        color     = 0;
+
+    while (row < last) {
+        uint16_t run = 0;
+        uint8_t  length;
+        do {
+            length = *runs++;
+            run += length;
+        } while (length == UINT8_MAX);
+
+        // A run can continue over several rows
+        while (run > 0 && row < last) {
+            uint16_t span = MIN(run, asset->width - column);
+
+            if (row >= first && column < width) {
+                fill_span(&canvas->buffer[(y + row - canvas->top) * canvas->width + x + column], colors[color], MIN(column + span, width) - column);
+            }
+
+            run -= span;
+            column += span;
+            if (column == asset->width) {
+                column = 0;
+                row++;
+            }
+        }
+        color ^= 1;
+    }
+}
+#else
+// Straight copy from flash, one memcpy per row clipped to the canvas
+void hlc_asset_blit(const hlc_canvas_t *canvas, const hlc_asset_t *asset, uint16_t x, uint16_t y) {
+    if (x >= canvas->width) {
+        return;
+    }
+
+    uint16_t first = MAX(y, canvas->top);
+    uint16_t last  = MIN(y + asset->height, canvas->top + canvas->height);
+    uint16_t width = MIN(asset->width, canvas->width - x);
+
+    for (uint16_t py = first; py < last; py++) {
+        memcpy(&canvas->buffer[(py - canvas->top) * canvas->width + x], &asset->pixels[(py - y) * asset->width], width * sizeof(hlc_pixel_t));
+    }
+}
+#endif
@@ -0,0 +1,37 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "hlc_tft_raster.h"
+
+#ifdef HLC_TFT_ASSET_BUNDLE
+// Two colour images packed in a single run length encoded bundle, generated from the QGF/QFF graphics by tools/hlc_assets.py at build time
+typedef struct {
+    uint16_t       width;
+    uint16_t       height;
+    uint8_t        palette; // Index in hlc_asset_palettes
+    const uint8_t *runs;    // Alternating background/foreground runs, a 255 byte continues the run
+} hlc_asset_t;
+
+extern const uint8_t hlc_asset_palettes[][2]; // Foreground and background hlc_color_t
+#else
+// Pre-coloured images in the framebuffer format, generated from the QGF/QFF graphics by tools/hlc_assets.py at build time
+typedef struct {
+    uint16_t           width;
+    uint16_t           height;
+    const hlc_pixel_t *pixels;
+} hlc_asset_t;
+#endif
+
+#define HLC_ASSET_NUMBER_UNDEF 10
+
+extern const hlc_asset_t hlc_asset_numbers[11]; // 0-9 in their layer colour, then the undefined layer
+extern const hlc_asset_t hlc_asset_caps_off;
+extern const hlc_asset_t hlc_asset_caps_on;
+extern const hlc_asset_t hlc_asset_num_off;
+extern const hlc_asset_t hlc_asset_num_on;
+extern const hlc_asset_t hlc_asset_scroll_off;
+extern const hlc_asset_t hlc_asset_scroll_on;
+
+void hlc_asset_blit(const hlc_canvas_t *canvas, const hlc_asset_t *asset, uint16_t x, uint16_t y);
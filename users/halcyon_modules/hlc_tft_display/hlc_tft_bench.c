@@ -0,0 +1,75 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_bench.h"
+
+#include "ch.h"
+#include "print.h"
+
+static const char *const zone_names[HLC_BENCH_COUNT] = {
+    [HLC_BENCH_UPDATE_GRID]    = "update_grid",
+    [HLC_BENCH_DRAW_GRID]      = "draw_grid",
+    [HLC_BENCH_DRAW_STATUS]    = "draw_status",
+    [HLC_BENCH_UPDATE_DISPLAY] = "update_display",
+    [HLC_BENCH_FLUSH]          = "flush",
+};
+
+static hlc_bench_stats_t bench_stats[HLC_BENCH_COUNT];
+
+uint32_t hlc_bench_begin(void) {
+    return chVTGetSystemTimeX();
+}
+
+void hlc_bench_end(hlc_bench_zone_t zone, uint32_t start) {
+    hlc_bench_stats_t *stats   = &bench_stats[zone];
+    uint32_t           elapsed = TIME_I2US(chVTTimeElapsedSinceX((systime_t)start));
+
+    stats->calls++;
+    stats->total_us += elapsed;
+    if (elapsed > stats->max_us) {
+        stats->max_us = elapsed;
+    }
+}
+
+void hlc_bench_reset(void) {
+    for (uint8_t i = 0; i < HLC_BENCH_COUNT; i++) {
+        bench_stats[i] = (hlc_bench_stats_t){0};
+    }
+}
+
+void hlc_bench_report(uint32_t crc) {
+    uprintf("hlc_tft bench: %u frames, seed %u\n", HLC_TFT_BENCH_FRAMES, HLC_TFT_BENCH_SEED);
+    for (uint8_t i = 0; i < HLC_BENCH_COUNT; i++) {
+        const hlc_bench_stats_t *stats = &bench_stats[i];
+        if (stats->calls == 0) {
+            continue;
+        }
+        uprintf("  %-14s %6lu calls %8lu us total %6lu us avg %6lu us max\n", zone_names[i], stats->calls, stats->total_us, stats->total_us / stats->calls, stats->max_us);
+    }
+
+#ifdef HLC_TFT_BENCH_GOLDEN
+    uprintf("  framebuffer crc %08lx: %s\n", crc, crc == HLC_TFT_BENCH_GOLDEN ? "matches golden" : "MISMATCH");
+#else
+    uprintf("  framebuffer crc %08lx (define HLC_TFT_BENCH_GOLDEN to check it)\n", crc);
+#endif
+}
+
+const hlc_bench_stats_t *hlc_bench_get_stats(hlc_bench_zone_t zone) {
+    return &bench_stats[zone];
+}
+
+// Plain bitwise CRC-32 (IEEE), speed doesn't matter here. Start with 0 and pass the result on to continue it.
+uint32_t hlc_bench_crc32(uint32_t crc, const void *data, size_t length) {
+    const uint8_t *bytes = data;
+
+    crc = ~crc;
+
+    while (length--) {
+        crc ^= *bytes++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+
+    return ~crc;
+}
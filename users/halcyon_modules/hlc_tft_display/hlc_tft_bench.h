@@ -0,0 +1,58 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Scripted frames rendered by the boot benchmark
+#ifndef HLC_TFT_BENCH_FRAMES
+#    define HLC_TFT_BENCH_FRAMES 2000
+#endif
+
+// Seed of the scripted run, the golden checksum is only valid for one seed and frame count
+#ifndef HLC_TFT_BENCH_SEED
+#    define HLC_TFT_BENCH_SEED 1
+#endif
+
+// Time after boot before the benchmark starts, so the console can be attached
+#ifndef HLC_TFT_BENCH_DELAY
+#    define HLC_TFT_BENCH_DELAY 5000
+#endif
+
+typedef enum {
+    HLC_BENCH_UPDATE_GRID,
+    HLC_BENCH_DRAW_GRID,
+    HLC_BENCH_DRAW_STATUS,
+    HLC_BENCH_UPDATE_DISPLAY,
+    HLC_BENCH_FLUSH,
+    HLC_BENCH_COUNT
+} hlc_bench_zone_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t total_us;
+    uint32_t max_us;
+} hlc_bench_stats_t;
+
+#ifdef HLC_TFT_BENCH
+#    define HLC_BENCH(zone, ...)                \
+        do {                                    \
+            uint32_t _start = hlc_bench_begin(); \
+            __VA_ARGS__;                        \
+            hlc_bench_end(zone, _start);        \
+        } while (0)
+#else
+#    define HLC_BENCH(zone, ...) \
+        do {                     \
+            __VA_ARGS__;         \
+        } while (0)
+#endif
+
+uint32_t hlc_bench_begin(void);
+void hlc_bench_end(hlc_bench_zone_t zone, uint32_t start);
+void hlc_bench_reset(void);
+void hlc_bench_report(uint32_t crc);
+const hlc_bench_stats_t *hlc_bench_get_stats(hlc_bench_zone_t zone);
+uint32_t hlc_bench_crc32(uint32_t crc, const void *data, size_t length);
@@ -0,0 +1,87 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_core1.h"
+
+#include "hal.h"
+
+// Which core may touch the framebuffer
+enum {
+    OWNER_CORE1,
+    OWNER_CORE0,
+};
+
+static hlc_ring_t            ring;
+static atomic_uint           owner = OWNER_CORE0;
+static hlc_core1_input_cb_t  input_cb;
+static hlc_core1_render_cb_t render_cb;
+static hlc_core1_stats_t     core1_stats;
+
+// Last value queued per input, so only changes use the ring
+static uint32_t input_values[HLC_CORE1_INPUTS];
+static uint8_t  input_queued = 0;
+
+_Static_assert(HLC_CORE1_INPUTS <= 8, "input_queued holds one bit per input");
+
+// Sleeps until core0 hands over the framebuffer, parks in between are served by hlc_core1_yield()
+static void wait_for_frame(void) {
+    hlc_core1_yield();
+    while (atomic_load(&owner) != OWNER_CORE1) {
+        __WFE();
+        hlc_core1_yield();
+    }
+}
+
+static void core1_main(void) {
+    hlc_msg_t msg;
+
+    for (;;) {
+        wait_for_frame();
+
+        while (hlc_ring_pop(&ring, &msg)) {
+            input_cb(&msg);
+        }
+        render_cb();
+
+        core1_stats.frames++;
+        atomic_store(&owner, OWNER_CORE0);
+    }
+}
+
+// Core0 keeps the framebuffer until the first release, so drawing done right after this is safe
+void hlc_core1_start(hlc_core1_input_cb_t input, hlc_core1_render_cb_t render) {
+    input_cb  = input;
+    render_cb = render;
+    hlc_core1_launch(core1_main, false);
+}
+
+// Queues the value when it differs from the last one queued, a full ring is retried on the next call
+void hlc_core1_set_input(hlc_core1_input_t type, uint32_t value) {
+    if ((input_queued & (1 << type)) && input_values[type] == value) {
+        return;
+    }
+
+    hlc_msg_t msg = {.type = type, .value = value};
+    if (!hlc_ring_push(&ring, &msg)) {
+        core1_stats.ring_full++;
+        return;
+    }
+    input_values[type] = value;
+    input_queued |= 1 << type;
+    core1_stats.posted++;
+}
+
+// True while core0 owns the framebuffer
+bool hlc_core1_frame_ready(void) {
+    return atomic_load(&owner) == OWNER_CORE0;
+}
+
+// Lets core1 draw the next frame, the previous one has to be on the display by now
+void hlc_core1_release_frame(void) {
+    atomic_store(&owner, OWNER_CORE1);
+    __SEV();
+}
+
+const hlc_core1_stats_t *hlc_core1_get_stats(void) {
+    return &core1_stats;
+}
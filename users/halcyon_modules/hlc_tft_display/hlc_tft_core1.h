@@ -0,0 +1,34 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "hlc_core1.h"
+#include "hlc_ring.h"
+
+// State core0 hands over to the renderer, each one is posted again whenever it changes
+typedef enum {
+    HLC_CORE1_LED,            // host_keyboard_led_state().raw
+    HLC_CORE1_LAYER,          // Highest active layer
+    HLC_CORE1_ACTIVITY,       // last_matrix_activity_time()
+    HLC_CORE1_SECOND_DISPLAY, // This half shows the Life animation
+    HLC_CORE1_INPUTS,
+} hlc_core1_input_t;
+
+// Both run on core1 while it owns the framebuffer: the queued inputs are applied, then the frame is drawn
+typedef void (*hlc_core1_input_cb_t)(const hlc_msg_t *msg);
+typedef void (*hlc_core1_render_cb_t)(void);
+
+typedef struct {
+    uint32_t posted;    // Inputs queued by core0
+    uint32_t ring_full; // Inputs that had to wait for a later tick
+    uint32_t frames;    // Frames handed from core1 to core0
+} hlc_core1_stats_t;
+
+// Core0 side. The framebuffer (with the dirty tiles, the Life grid and the strip display list) belongs to core0 from
+// hlc_core1_start() on until it calls hlc_core1_release_frame(), and again once hlc_core1_frame_ready() returns true.
+void hlc_core1_start(hlc_core1_input_cb_t input, hlc_core1_render_cb_t render);
+void hlc_core1_set_input(hlc_core1_input_t type, uint32_t value);
+bool hlc_core1_frame_ready(void);
+void hlc_core1_release_frame(void);
+const hlc_core1_stats_t *hlc_core1_get_stats(void);
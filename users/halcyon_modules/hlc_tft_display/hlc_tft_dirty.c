@@ -0,0 +1,218 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_dirty.h"
+
+#include <string.h>
+#include "util.h"
+#include "print.h"
+#include "qp_surface_internal.h"
+
+_Static_assert(HLC_DIRTY_TILES_X <= 16, "Dirty tile rows are stored in 16 bits, increase HLC_DIRTY_TILE_SIZE");
+
+static uint16_t          dirty_rows[HLC_DIRTY_TILES_Y]; // One bit per tile
+static hlc_dirty_stats_t dirty_stats;
+
+static inline uint32_t rect_area(const hlc_rect_t *rect) {
+    return (uint32_t)(rect->r - rect->l + 1) * (rect->b - rect->t + 1);
+}
+
+static inline hlc_rect_t rect_union(const hlc_rect_t *a, const hlc_rect_t *b) {
+    hlc_rect_t rect = {
+        .l = MIN(a->l, b->l),
+        .t = MIN(a->t, b->t),
+        .r = MAX(a->r, b->r),
+        .b = MAX(a->b, b->b),
+    };
+    return rect;
+}
+
+// Extra pixels sent when merging both rects, minus the window that is saved
+static int32_t merge_cost(const hlc_rect_t *a, const hlc_rect_t *b) {
+    hlc_rect_t merged = rect_union(a, b);
+    return (int32_t)rect_area(&merged) - (int32_t)rect_area(a) - (int32_t)rect_area(b) - HLC_DIRTY_WINDOW_COST;
+}
+
+// Adds a run of dirty tiles to the plan, merging it into an existing window when that is cheaper
+static void add_rect(hlc_rect_t *rects, uint8_t *count, const hlc_rect_t *run) {
+    int32_t best_cost  = INT32_MAX;
+    uint8_t best_index = 0;
+
+    for (uint8_t i = 0; i < *count; i++) {
+        int32_t cost = merge_cost(&rects[i], run);
+        if (cost < best_cost) {
+            best_cost  = cost;
+            best_index = i;
+        }
+    }
+
+    // Merge when it saves bytes, or when we are out of windows
+    if (*count > 0 && (best_cost <= 0 || *count >= HLC_DIRTY_MAX_RECTS)) {
+        rects[best_index] = rect_union(&rects[best_index], run);
+        return;
+    }
+
+    rects[(*count)++] = *run;
+}
+
+void hlc_dirty_mark(uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    if (left >= LCD_WIDTH || top >= LCD_HEIGHT) {
+        return;
+    }
+    right  = MIN(right, LCD_WIDTH - 1);
+    bottom = MIN(bottom, LCD_HEIGHT - 1);
+
+    uint8_t  tx_start = left / HLC_DIRTY_TILE_SIZE;
+    uint8_t  tx_end   = right / HLC_DIRTY_TILE_SIZE;
+    uint16_t bits     = (uint16_t)(((1UL << (tx_end + 1)) - 1) & ~((1UL << tx_start) - 1));
+
+    for (uint8_t ty = top / HLC_DIRTY_TILE_SIZE; ty <= bottom / HLC_DIRTY_TILE_SIZE; ty++) {
+        dirty_rows[ty] |= bits;
+    }
+}
+
+void hlc_dirty_mark_all(void) {
+    hlc_dirty_mark(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+}
+
+bool hlc_dirty_pending(void) {
+    for (uint8_t ty = 0; ty < HLC_DIRTY_TILES_Y; ty++) {
+        if (dirty_rows[ty]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Takes over (or drops) the single bounding box Quantum Painter keeps for the surface
+void hlc_dirty_sync_surface(painter_device_t surface, bool absorb) {
+    surface_painter_device_t *device = (surface_painter_device_t *)surface;
+
+    // There is no surface on top of an indexed framebuffer
+    if (device == NULL || !device->dirty.is_dirty) {
+        return;
+    }
+
+    if (absorb) {
+        hlc_dirty_mark(device->dirty.l, device->dirty.t, device->dirty.r, device->dirty.b);
+    }
+
+    device->dirty.is_dirty = false;
+    device->dirty.l        = UINT16_MAX;
+    device->dirty.t        = UINT16_MAX;
+    device->dirty.r        = 0;
+    device->dirty.b        = 0;
+}
+
+// Turns the dirty tiles into at most HLC_DIRTY_MAX_RECTS windows
+uint8_t hlc_dirty_plan(hlc_rect_t *rects) {
+    uint8_t count = 0;
+
+    for (uint8_t ty = 0; ty < HLC_DIRTY_TILES_Y; ty++) {
+        uint16_t bits = dirty_rows[ty];
+        uint8_t  tx   = 0;
+
+        while (bits) {
+            while (!(bits & 1)) {
+                bits >>= 1;
+                tx++;
+            }
+            uint8_t start = tx;
+            while (bits & 1) {
+                bits >>= 1;
+                tx++;
+            }
+
+            hlc_rect_t run = {
+                .l = start * HLC_DIRTY_TILE_SIZE,
+                .t = ty * HLC_DIRTY_TILE_SIZE,
+                .r = MIN(tx * HLC_DIRTY_TILE_SIZE, LCD_WIDTH) - 1,
+                .b = MIN((ty + 1) * HLC_DIRTY_TILE_SIZE, LCD_HEIGHT) - 1,
+            };
+            add_rect(rects, &count, &run);
+        }
+    }
+
+    return count;
+}
+
+// Full width bands of dirty tile rows, each one is a single contiguous run of the framebuffer
+uint8_t hlc_dirty_plan_bands(hlc_rect_t *rects) {
+    uint8_t count = 0;
+
+    for (uint8_t ty = 0; ty < HLC_DIRTY_TILES_Y; ty++) {
+        if (!dirty_rows[ty]) {
+            continue;
+        }
+
+        uint16_t top    = ty * HLC_DIRTY_TILE_SIZE;
+        uint16_t bottom = MIN((ty + 1) * HLC_DIRTY_TILE_SIZE, LCD_HEIGHT) - 1;
+        if (count > 0 && rects[count - 1].b + 1 == top) {
+            rects[count - 1].b = bottom;
+        } else {
+            rects[count++] = (hlc_rect_t){.l = 0, .t = top, .r = LCD_WIDTH - 1, .b = bottom};
+        }
+    }
+
+    return count;
+}
+
+// Clears the tiles once the planned windows are on their way and keeps the statistics
+void hlc_dirty_commit(const hlc_rect_t *rects, uint8_t count) {
+    uint32_t bytes = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        bytes += rect_area(&rects[i]) * sizeof(uint16_t);
+    }
+
+    memset(dirty_rows, 0, sizeof(dirty_rows));
+
+    dirty_stats.frames++;
+    dirty_stats.bytes_last_frame = bytes;
+    dirty_stats.bytes_total += bytes;
+    dirty_stats.rects_last_frame = count;
+}
+
+void hlc_dirty_flush(painter_device_t surface, painter_device_t target, const hlc_pixel_t *framebuffer) {
+    hlc_rect_t rects[HLC_DIRTY_MAX_RECTS];
+#ifdef HLC_TFT_INDEXED_FB
+    static uint16_t line[LCD_WIDTH];
+#endif
+
+    hlc_dirty_sync_surface(surface, true);
+
+    uint8_t count = hlc_dirty_plan(rects);
+    if (count == 0) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        const hlc_rect_t *rect  = &rects[i];
+        uint16_t          width = rect->r - rect->l + 1;
+
+        if (!qp_viewport(target, rect->l, rect->t, rect->r, rect->b)) {
+            continue;
+        }
+
+        // Rows of a window are not contiguous in the framebuffer, send them one by one
+        for (uint16_t y = rect->t; y <= rect->b; y++) {
+#ifdef HLC_TFT_INDEXED_FB
+            hlc_raster_expand(line, &framebuffer[y * LCD_WIDTH + rect->l], width);
+            qp_pixdata(target, line, width);
+#else
+            qp_pixdata(target, &framebuffer[y * LCD_WIDTH + rect->l], width);
+#endif
+        }
+    }
+
+    hlc_dirty_commit(rects, count);
+}
+
+// Prints the flush statistics on the console, they keep counting afterwards
+void hlc_dirty_dump(void) {
+    uprintf("hlc_tft: %lu flushes, %lu bytes, last %u windows with %lu bytes\n", dirty_stats.frames, dirty_stats.bytes_total, dirty_stats.rects_last_frame, dirty_stats.bytes_last_frame);
+}
+
+const hlc_dirty_stats_t *hlc_dirty_get_stats(void) {
+    return &dirty_stats;
+}
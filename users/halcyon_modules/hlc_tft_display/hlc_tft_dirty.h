@@ -0,0 +1,52 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "qp.h"
+#include "hlc_tft_raster.h"
+
+// The display is split in tiles, dirty state is kept per tile (one bit each)
+#ifndef HLC_DIRTY_TILE_SIZE
+#    define HLC_DIRTY_TILE_SIZE 15
+#endif
+#define HLC_DIRTY_TILES_X ((LCD_WIDTH + HLC_DIRTY_TILE_SIZE - 1) / HLC_DIRTY_TILE_SIZE)
+#define HLC_DIRTY_TILES_Y ((LCD_HEIGHT + HLC_DIRTY_TILE_SIZE - 1) / HLC_DIRTY_TILE_SIZE)
+
+// Maximum amount of windows sent to the LCD per flush
+#ifndef HLC_DIRTY_MAX_RECTS
+#    define HLC_DIRTY_MAX_RECTS 8
+#endif
+
+// Cost of opening an extra window on the LCD expressed in pixels (CASET/RASET/RAMWR commands and CS toggles)
+#ifndef HLC_DIRTY_WINDOW_COST
+#    define HLC_DIRTY_WINDOW_COST 64
+#endif
+
+// Full width bands alternate with clean tile rows at worst
+#define HLC_DIRTY_MAX_BANDS ((HLC_DIRTY_TILES_Y + 1) / 2)
+
+// Put this keycode in a keymap to print the flush statistics on the console
+#define HLC_TFT_STATS_DUMP QK_KB_1
+
+typedef struct {
+    uint16_t l, t, r, b; // Inclusive
+} hlc_rect_t;
+
+typedef struct {
+    uint32_t frames;           // Flushes that sent at least one window
+    uint32_t bytes_last_frame; // Bytes pushed over SPI by the last flush
+    uint32_t bytes_total;      // Bytes pushed over SPI since boot
+    uint8_t  rects_last_frame; // Windows sent by the last flush
+} hlc_dirty_stats_t;
+
+void hlc_dirty_mark(uint16_t left, uint16_t top, uint16_t right, uint16_t bottom);
+void hlc_dirty_mark_all(void);
+bool hlc_dirty_pending(void);
+void hlc_dirty_sync_surface(painter_device_t surface, bool absorb);
+uint8_t hlc_dirty_plan(hlc_rect_t *rects);
+uint8_t hlc_dirty_plan_bands(hlc_rect_t *rects);
+void hlc_dirty_commit(const hlc_rect_t *rects, uint8_t count);
+void hlc_dirty_flush(painter_device_t surface, painter_device_t target, const hlc_pixel_t *framebuffer);
+void hlc_dirty_dump(void);
+const hlc_dirty_stats_t *hlc_dirty_get_stats(void);
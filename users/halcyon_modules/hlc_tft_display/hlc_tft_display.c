@@ -3,37 +3,69 @@
 
 #include "halcyon.h"
 #include "hlc_tft_display.h"
-
+#include "hlc_tft_dirty.h"
+#include "hlc_tft_life.h"
+#include "hlc_tft_raster.h"
+#include "hlc_tft_tiles.h"
+#include "hlc_tft_sched.h"
+#include "hlc_tft_bench.h"
+#include "hlc_tft_power.h"
+#ifdef HLC_TFT_ASYNC_FLUSH
+#    include "hlc_tft_spi.h"
+#endif
+#ifdef HLC_TFT_CORE1
+#    include "hlc_tft_core1.h"
+#endif
+
+#include "ch.h"
 #include "qp_surface.h"
 #include <time.h>
 
+#ifdef HLC_TFT_NATIVE_ASSETS
+// Numbers and indicators, pre-coloured at build time
+#    include "hlc_tft_assets.h"
+#    ifdef HLC_TFT_STRIP_RENDER
+#        include "hlc_tft_strip.h"
+#    endif
+#else
 // Fonts mono2
-#include "graphics/fonts/Retron2000-27.qff.h"
-#include "graphics/fonts/Retron2000-underline-27.qff.h"
+#    include "graphics/fonts/Retron2000-27.qff.h"
+#    include "graphics/fonts/Retron2000-underline-27.qff.h"
 
 // Numbers mono2
-#include "graphics/numbers/0.qgf.h"
-#include "graphics/numbers/1.qgf.h"
-#include "graphics/numbers/2.qgf.h"
-#include "graphics/numbers/3.qgf.h"
-#include "graphics/numbers/4.qgf.h"
-#include "graphics/numbers/5.qgf.h"
-#include "graphics/numbers/6.qgf.h"
-#include "graphics/numbers/7.qgf.h"
-#include "graphics/numbers/8.qgf.h"
-#include "graphics/numbers/9.qgf.h"
-#include "graphics/numbers/undef.qgf.h"
+#    include "graphics/numbers/0.qgf.h"
+#    include "graphics/numbers/1.qgf.h"
+#    include "graphics/numbers/2.qgf.h"
+#    include "graphics/numbers/3.qgf.h"
+#    include "graphics/numbers/4.qgf.h"
+#    include "graphics/numbers/5.qgf.h"
+#    include "graphics/numbers/6.qgf.h"
+#    include "graphics/numbers/7.qgf.h"
+#    include "graphics/numbers/8.qgf.h"
+#    include "graphics/numbers/9.qgf.h"
+#    include "graphics/numbers/undef.qgf.h"
+#endif
 
 static const char *caps =        "Caps";
 static const char *num =         "Num";
 static const char *scroll =      "Scroll";
 
+#ifndef HLC_TFT_NATIVE_ASSETS
 static painter_font_handle_t Retron27;
 static painter_font_handle_t Retron27_underline;
-static painter_image_handle_t layer_number;
+#endif
 backlight_config_t backlight_config;
 
-static uint16_t lcd_surface_fb[135*240];
+#if defined(HLC_TFT_INDEXED_FB) && !defined(HLC_TFT_NATIVE_ASSETS)
+#    error "HLC_TFT_INDEXED_FB needs HLC_TFT_NATIVE_ASSETS, text and images can't be drawn by Quantum Painter without a surface"
+#endif
+#if defined(HLC_TFT_STRIP_RENDER) && (!defined(HLC_TFT_NATIVE_ASSETS) || !defined(HLC_TFT_ASYNC_FLUSH) || defined(HLC_TFT_INDEXED_FB))
+#    error "HLC_TFT_STRIP_RENDER needs HLC_TFT_NATIVE_ASSETS and HLC_TFT_ASYNC_FLUSH, and replaces HLC_TFT_INDEXED_FB"
+#endif
+
+#ifndef HLC_TFT_STRIP_RENDER
+static hlc_pixel_t lcd_surface_fb[135*240] __attribute__((aligned(4)));
+#endif
 
 int color_value = 0;
 
@@ -41,213 +73,463 @@ painter_device_t lcd;
 painter_device_t lcd_surface;
 
 led_t last_led_usb_state = {0};
-layer_state_t last_layer_state = {0};
-
-#define GRID_WIDTH 27
-#define GRID_HEIGHT 48
-#define CELL_SIZE 4  // Cell size excluding outline
-#define OUTLINE_SIZE 1
-
-// Define the probability factor for initial alive cells
-#define INITIAL_ALIVE_PROBABILITY 0.2  // 20% chance of being alive
-
-bool grid[GRID_HEIGHT][GRID_WIDTH];  // Current state
-bool new_grid[GRID_HEIGHT][GRID_WIDTH];  // Next state
-bool changed_grid[GRID_HEIGHT][GRID_WIDTH]; // Tracks changed cells
-
-void init_grid() {
-    // Initialize grid with alive cells
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            grid[y][x] = (rand() < INITIAL_ALIVE_PROBABILITY * RAND_MAX);  // Use probability factor
-            changed_grid[y][x] = true;      // Mark all as changed initially
+static uint8_t last_layer = 0;
+static bool first_run_led = false;
+static bool first_run_layer = false;
+
+// What the display shows, read on core0 (and handed over to core1 with HLC_TFT_CORE1)
+static led_t    display_led_state;
+static uint8_t  display_layer;
+static uint32_t display_activity_time;
+static bool     display_second;
+
+#ifndef HLC_TFT_STRIP_RENDER
+static hlc_canvas_t lcd_canvas = {lcd_surface_fb, LCD_WIDTH, 0, LCD_HEIGHT};
+#endif
+
+#ifdef HLC_TFT_NATIVE_ASSETS
+#    define LAYER_NUMBER_UNDEF HLC_ASSET_NUMBER_UNDEF
+#    define INDICATOR_HEIGHT hlc_asset_caps_off.height
+
+#    ifdef HLC_TFT_STRIP_RENDER
+// Only the display list is updated, the strips are rendered while flushing
+#        define ITEM(item) item
+static void draw_asset(hlc_strip_item_t item, const hlc_asset_t *asset, uint16_t x, uint16_t y) {
+    hlc_strip_set_item(item, asset, x, y);
+}
+#    else
+#        define ITEM(item) 0
+static void draw_asset(uint8_t item, const hlc_asset_t *asset, uint16_t x, uint16_t y) {
+    hlc_asset_blit(&lcd_canvas, asset, x, y);
+    hlc_dirty_mark(x, y, x + asset->width - 1, y + asset->height - 1);
+}
+#    endif
+
+static void load_layer_numbers(void) {}
+
+// The colour is part of the asset
+static void draw_layer_number(uint8_t index, hlc_color_t color) {
+    draw_asset(ITEM(HLC_STRIP_LAYER), &hlc_asset_numbers[index], 5, 5);
+}
+
+static void draw_indicator(uint16_t y, const char *text, bool on, hlc_color_t color_off, hlc_color_t color_on) {
+    if (text == caps) {
+        draw_asset(ITEM(HLC_STRIP_CAPS), on ? &hlc_asset_caps_on : &hlc_asset_caps_off, 5, y);
+    } else if (text == num) {
+        draw_asset(ITEM(HLC_STRIP_NUM), on ? &hlc_asset_num_on : &hlc_asset_num_off, 5, y);
+    } else {
+        draw_asset(ITEM(HLC_STRIP_SCROLL), on ? &hlc_asset_scroll_on : &hlc_asset_scroll_off, 5, y);
+    }
+}
+
+static void load_indicators(void) {}
+#else
+#    define INDICATOR_HEIGHT Retron27->line_height
+
+// Layer numbers, decoded once at boot
+#define LAYER_NUMBER_UNDEF 10
+static const uint8_t *const layer_number_gfx[] = {gfx_0, gfx_1, gfx_2, gfx_3, gfx_4, gfx_5, gfx_6, gfx_7, gfx_8, gfx_9, gfx_undef};
+static hlc_tile_t layer_number_tiles[ARRAY_SIZE(layer_number_gfx)];
+
+static void load_layer_numbers(void) {
+    for (uint8_t i = 0; i < ARRAY_SIZE(layer_number_gfx); i++) {
+        painter_image_handle_t image = qp_load_image_mem(layer_number_gfx[i]);
+        if (image == NULL) {
+            continue;
         }
+
+        // Draw white on black in the corner of the (not yet shown) surface and read it back
+        qp_drawimage_recolor(lcd_surface, 0, 0, image, HSV_WHITE, HSV_BLACK);
+        hlc_tile_capture(&layer_number_tiles[i], &lcd_canvas, 0, 0, image->width, image->height, hlc_palette[HLC_COLOR_BLACK]);
+        hlc_raster_fill(&lcd_canvas, 0, 0, image->width - 1, image->height - 1, hlc_palette[HLC_COLOR_BLACK]);
+        qp_close_image(image);
     }
+    hlc_dirty_sync_surface(lcd_surface, false);
+}
+
+static void draw_layer_number(uint8_t index, hlc_color_t color) {
+    const hlc_tile_t *tile = &layer_number_tiles[index];
+
+    if (tile->mask != NULL) {
+        hlc_tile_blit(&lcd_canvas, tile, 5, 5, hlc_palette[color], hlc_palette[HLC_COLOR_BLACK]);
+        hlc_dirty_mark(5, 5, 5 + tile->width - 1, 5 + tile->height - 1);
+        return;
+    }
+
+    // Tile pool was too small, decode from flash
+    painter_image_handle_t image = qp_load_image_mem(layer_number_gfx[index]);
+    if (image != NULL) {
+        const hsv_t *hsv = &hlc_palette_hsv[color];
+        qp_drawimage_recolor(lcd_surface, 5, 5, image, hsv->h, hsv->s, hsv->v, HSV_BLACK);
+        hlc_dirty_mark(5, 5, 5 + image->width - 1, 5 + image->height - 1);
+        qp_close_image(image);
+    }
+}
+
+static void draw_indicator(uint16_t y, const char *text, bool on, hlc_color_t color_off, hlc_color_t color_on) {
+    painter_font_handle_t font  = on ? Retron27_underline : Retron27;
+    int16_t               width = hlc_text_draw(&lcd_canvas, lcd_surface, 5, y, font, text, on ? color_on : color_off, HLC_COLOR_BLACK);
+
+    if (width > 0) {
+        hlc_dirty_mark(5, y, 5 + width - 1, y + font->line_height - 1);
+    }
+}
+
+// Renders the six indicator variants while the surface isn't shown yet, so they are cached from the start
+static void load_indicators(void) {
+    static const struct {
+        const char *const *text;
+        hlc_color_t        off;
+        hlc_color_t        on;
+    } indicators[] = {
+        {&caps, HLC_COLOR_CAPS_OFF, HLC_COLOR_CAPS_ON},
+        {&num, HLC_COLOR_NUM_OFF, HLC_COLOR_NUM_ON},
+        {&scroll, HLC_COLOR_SCROLL_OFF, HLC_COLOR_SCROLL_ON},
+    };
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(indicators); i++) {
+        hlc_text_draw(&lcd_canvas, lcd_surface, 0, 0, Retron27, *indicators[i].text, indicators[i].off, HLC_COLOR_BLACK);
+        hlc_text_draw(&lcd_canvas, lcd_surface, 0, 0, Retron27_underline, *indicators[i].text, indicators[i].on, HLC_COLOR_BLACK);
+    }
+    hlc_raster_fill(&lcd_canvas, 0, 0, LCD_WIDTH - 1, Retron27->line_height - 1, hlc_palette[HLC_COLOR_BLACK]);
+    hlc_dirty_sync_surface(lcd_surface, false);
+}
+#endif
+
+// Draws rows [y, y + count) of the grid, returns the row to continue from
+static uint8_t draw_grid_rows(uint8_t y, uint8_t count) {
+    hlc_color_t color = (color_value >= 0 && color_value < 8) ? HLC_COLOR_LAYER_0 + color_value : HLC_COLOR_LAYER_UNDEF;
+    uint8_t     end   = MIN(y + count, GRID_HEIGHT);
+
+    for (; y < end; y++) {
+        uint32_t changed = life_changed[y];
+        if (!changed) { // Only update changed cells
+            continue;
+        }
+
+#ifdef HLC_TFT_STRIP_RENDER
+        hlc_strip_set_life(true, color);
+#else
+        hlc_raster_life_row(&lcd_canvas, y, changed, life_grid[y], hlc_palette[color]);
+#endif
+
+        // One dirty span per row, from the first to the last changed cell
+        uint8_t first = __builtin_ctz(changed);
+        uint8_t last  = 31 - __builtin_clz(changed);
+        hlc_dirty_mark(first * 5, y * 5, last * 5 + 4, y * 5 + 4);
+        life_changed[y] = 0;
+    }
+
+    return y;
 }
 
 void draw_grid() {
-    uint8_t hue = 0;  // Hue for alive cells
-    uint8_t sat = 0;  // Saturation for alive cells
-    uint8_t val_dead = 0;  // Brightness for dead cells
-
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            if (changed_grid[y][x]) { // Only update changed cells
-                uint16_t left = x * (CELL_SIZE + OUTLINE_SIZE);
-                uint16_t top = y * (CELL_SIZE + OUTLINE_SIZE);
-                uint16_t right = left + CELL_SIZE + OUTLINE_SIZE;
-                uint16_t bottom = top + CELL_SIZE + OUTLINE_SIZE;
-
-                // Draw the outline
-                qp_rect(lcd_surface, left, top, right, bottom, hue, sat, val_dead, true);
-
-                // Draw the filled cell inside the outline if it's alive
-                if (grid[y][x]) {
-                    switch (color_value) {
-                    case 0:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_0, true);
-                        break;
-                    case 1:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_1, true);
-                        break;
-                    case 2:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_2, true);
-                        break;
-                    case 3:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_3, true);
-                        break;
-                    case 4:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_4, true);
-                        break;
-                    case 5:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_5, true);
-                        break;
-                    case 6:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_6, true);
-                        break;
-                    case 7:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_7, true);
-                        break;
-                    default:
-                        qp_rect(lcd_surface, left + OUTLINE_SIZE, top + OUTLINE_SIZE, right - OUTLINE_SIZE, bottom - OUTLINE_SIZE, HSV_LAYER_UNDEF, true);
-                    }
-                }
-            }
+    draw_grid_rows(0, GRID_HEIGHT);
+}
+
+// A Life frame is split in stages so the scheduler can spread it over several housekeeping ticks
+static uint8_t  life_row = 0;
+static uint32_t  previous_matrix_activity_time = 0;
+static systime_t life_settled_time = 0; // Last generation that was still evolving
+
+static bool life_stage_draw(void) {
+    HLC_BENCH(HLC_BENCH_DRAW_GRID, life_row = draw_grid_rows(life_row, HLC_SCHED_ROWS_PER_SLICE));
+    if (life_row < GRID_HEIGHT) {
+        return false;
+    }
+    life_row = 0;
+    return true;
+}
+
+static bool life_stage_update(void) {
+    // Still lifes and oscillators are left alone until new cells are added
+    if (life_row == 0 && life_period()) {
+        return true;
+    }
+
+    HLC_BENCH(HLC_BENCH_UPDATE_GRID, life_row = update_grid_rows(life_row, HLC_SCHED_ROWS_PER_SLICE));
+    if (life_row < GRID_HEIGHT) {
+        return false;
+    }
+    life_row = 0;
+    if (!life_period()) {
+        life_settled_time = chVTGetSystemTimeX();
+    }
+    return true;
+}
+
+// Settled grids get new cells after HLC_LIFE_RESEED_TIMEOUT, as if a key was pressed
+static bool life_reseed_due(void) {
+#if HLC_LIFE_RESEED_TIMEOUT > 0
+    return life_period() && chVTTimeElapsedSinceX(life_settled_time) >= TIME_MS2I(HLC_LIFE_RESEED_TIMEOUT);
+#else
+    return false;
+#endif
+}
+
+// A settled grid without new key presses has nothing to simulate, only changes that weren't drawn yet
+static bool life_frame_needed(void) {
+    if (!life_period() || life_reseed_due() || previous_matrix_activity_time != display_activity_time) {
+        return true;
+    }
+    for (uint8_t y = 0; y < GRID_HEIGHT; y++) {
+        if (life_changed[y]) {
+            return true;
         }
     }
+    return false;
+}
+
+static bool life_stage_activity(void) {
+    if (previous_matrix_activity_time != display_activity_time) {
+        color_value = rand() % 8;
+        add_cell_cluster();
+        previous_matrix_activity_time = display_activity_time;
+    } else if (life_reseed_due()) {
+        add_cell_cluster();
+    }
+    return true;
 }
 
-void update_grid() {
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            int alive_neighbors = 0;
-
-            // Count alive neighbors
-            for (int dy = -1; dy <= 1; dy++) {
-                for (int dx = -1; dx <= 1; dx++) {
-                    if (dy == 0 && dx == 0) continue;  // Skip the current cell
-                    int ny = y + dy;
-                    int nx = x + dx;
-                    if (ny >= 0 && ny < GRID_HEIGHT && nx >= 0 && nx < GRID_WIDTH) {
-                        alive_neighbors += grid[ny][nx];
-                    }
-                }
-            }
-
-            // Apply the rules of the Game of Life
-            if (grid[y][x]) {
-                // Any live cell with two or three live neighbours survives.
-                new_grid[y][x] = (alive_neighbors == 2 || alive_neighbors == 3);
-            } else {
-                // Any dead cell with exactly three live neighbours becomes a live cell.
-                new_grid[y][x] = (alive_neighbors == 3);
-            }
-
-            // Track changed cells
-            changed_grid[y][x] = (grid[y][x] != new_grid[y][x]);
+#ifdef HLC_TFT_STRIP_RENDER
+// Cells are rendered from the grid at flush time, so the changes are marked once the generation is final
+static const hlc_sched_stage_t life_stages[] = {life_stage_update, life_stage_activity, life_stage_draw};
+#else
+static const hlc_sched_stage_t life_stages[] = {life_stage_draw, life_stage_update, life_stage_activity};
+#endif
+
+void update_display(void) {
+    if(last_led_usb_state.raw != display_led_state.raw || first_run_led == false) {
+        led_t led_usb_state = display_led_state;
+        led_t changed = {.raw = first_run_led ? (last_led_usb_state.raw ^ led_usb_state.raw) : 0xFF};
+
+        // Only redraw the indicators that flipped
+        if (changed.caps_lock) {
+            draw_indicator(LCD_HEIGHT - INDICATOR_HEIGHT * 3 - 15, caps, led_usb_state.caps_lock, HLC_COLOR_CAPS_OFF, HLC_COLOR_CAPS_ON);
+        }
+        if (changed.num_lock) {
+            draw_indicator(LCD_HEIGHT - INDICATOR_HEIGHT * 2 - 10, num, led_usb_state.num_lock, HLC_COLOR_NUM_OFF, HLC_COLOR_NUM_ON);
         }
+        if (changed.scroll_lock) {
+            draw_indicator(LCD_HEIGHT - INDICATOR_HEIGHT - 5, scroll, led_usb_state.scroll_lock, HLC_COLOR_SCROLL_OFF, HLC_COLOR_SCROLL_ON);
+        }
+
+        last_led_usb_state = led_usb_state;
+        first_run_led = true;
     }
 
-    // Copy new grid state to current grid
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            grid[y][x] = new_grid[y][x];
+    if(last_layer != display_layer || first_run_layer == false) {
+        uint8_t layer = display_layer;
+
+        if (layer < 8) {
+            draw_layer_number(layer, HLC_COLOR_LAYER_0 + layer);
+        } else {
+            draw_layer_number(LAYER_NUMBER_UNDEF, HLC_COLOR_LAYER_UNDEF);
         }
+        last_layer = layer;
+        first_run_layer = true;
     }
 }
 
-// Function to add a cluster of cells at a random position
-void add_cell_cluster() {
-    int cluster_size = 3;  // Size of the cluster (3x3)
-    int x = rand() % (GRID_WIDTH - cluster_size);
-    int y = rand() % (GRID_HEIGHT - cluster_size);
-
-    for (int dy = 0; dy < cluster_size; dy++) {
-        for (int dx = 0; dx < cluster_size; dx++) {
-            bool is_alive = rand() % 2; // Randomly choose between 0 and 1
-            grid[y + dy][x + dx] = is_alive;  // Set the cell to be alive
-            changed_grid[y + dy][x + dx] = true; // Mark the cell as changed
-        }
+// Moves the dirty parts of the surface to the lcd
+static void flush_display(bool wait) {
+    hlc_dirty_sync_surface(lcd_surface, false);
+#if defined(HLC_TFT_STRIP_RENDER)
+    hlc_spi_flush_start(NULL, lcd, NULL);
+    if (wait) {
+        hlc_spi_flush_wait();
+    }
+#elif defined(HLC_TFT_ASYNC_FLUSH)
+    hlc_spi_flush_start(lcd_surface, lcd, lcd_surface_fb);
+    if (wait) {
+        hlc_spi_flush_wait();
     }
+#else
+    hlc_dirty_flush(lcd_surface, lcd, lcd_surface_fb);
+#endif
 }
 
-void update_display(void) {
-    static bool first_run_led = false;
-    static bool first_run_layer = false;
+#ifdef HLC_TFT_BENCH
+// Blanks the screen, everything gets redrawn
+static void clear_screen(void) {
+#    ifdef HLC_TFT_STRIP_RENDER
+    for (uint8_t i = 0; i < HLC_STRIP_ITEMS; i++) {
+        hlc_strip_set_item(i, NULL, 0, 0);
+    }
+    hlc_strip_set_life(false, HLC_COLOR_BLACK);
+#    else
+    hlc_raster_fill(&lcd_canvas, 0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1, hlc_palette[HLC_COLOR_BLACK]);
+#    endif
+    hlc_dirty_mark_all();
+}
 
-    if( first_run_layer == false) {
-        // Load fonts
-        Retron27 = qp_load_font_mem(font_Retron2000_27);
-        Retron27_underline = qp_load_font_mem(font_Retron2000_underline_27);
+// Checksum of the image as it is sent to the display, so it is the same for every framebuffer format
+static uint32_t screen_crc(void) {
+    uint32_t crc = 0;
+
+    for (uint16_t y = 0; y < LCD_HEIGHT; y++) {
+#    if defined(HLC_TFT_STRIP_RENDER)
+        static uint16_t line[LCD_WIDTH] __attribute__((aligned(4)));
+        hlc_strip_render(line, y, 1);
+#    elif defined(HLC_TFT_INDEXED_FB)
+        static uint16_t line[LCD_WIDTH];
+        hlc_raster_expand(line, &lcd_surface_fb[y * LCD_WIDTH], LCD_WIDTH);
+#    else
+        const uint16_t *line = &lcd_surface_fb[y * LCD_WIDTH];
+#    endif
+        crc = hlc_bench_crc32(crc, line, LCD_WIDTH * sizeof(uint16_t));
     }
 
-    if(last_led_usb_state.raw != host_keyboard_led_state().raw || first_run_led == false) {
-        led_t led_usb_state = host_keyboard_led_state();
+    return crc;
+}
 
-        led_usb_state.caps_lock   ? qp_drawtext_recolor(lcd_surface, 5, LCD_HEIGHT - Retron27->line_height * 3 - 15, Retron27_underline, caps,   HSV_CAPS_ON,   HSV_BLACK) : qp_drawtext_recolor(lcd_surface, 5, LCD_HEIGHT - Retron27->line_height * 3 - 15, Retron27, caps,   HSV_CAPS_OFF,   HSV_BLACK);
-        led_usb_state.num_lock    ? qp_drawtext_recolor(lcd_surface, 5, LCD_HEIGHT - Retron27->line_height * 2 - 10, Retron27_underline, num,    HSV_NUM_ON,    HSV_BLACK) : qp_drawtext_recolor(lcd_surface, 5, LCD_HEIGHT - Retron27->line_height * 2 - 10, Retron27, num,    HSV_NUM_OFF,    HSV_BLACK);
-        led_usb_state.scroll_lock ? qp_drawtext_recolor(lcd_surface, 5, LCD_HEIGHT - Retron27->line_height - 5,      Retron27_underline, scroll, HSV_SCROLL_ON, HSV_BLACK) : qp_drawtext_recolor(lcd_surface, 5, LCD_HEIGHT - Retron27->line_height - 5,      Retron27, scroll, HSV_SCROLL_OFF, HSV_BLACK);
+// Renders a fixed script of frames, then reports the timings and a checksum of the resulting image
+static void run_bench(void) {
+    hlc_bench_reset();
+    srand(HLC_TFT_BENCH_SEED);
+    init_grid();
+    clear_screen();
+
+    for (uint16_t frame = 0; frame < HLC_TFT_BENCH_FRAMES; frame++) {
+        color_value = (frame / 64) % 8;
+        HLC_BENCH(HLC_BENCH_DRAW_GRID, draw_grid());
+        HLC_BENCH(HLC_BENCH_UPDATE_GRID, update_grid());
+        if (frame % 16 == 0) {
+            add_cell_cluster();
+        }
 
-        last_led_usb_state = led_usb_state;
-        first_run_led = true;
+        if (frame % 8 == 0) {
+            uint8_t number = (frame / 8) % (LAYER_NUMBER_UNDEF + 1);
+            bool    on     = (frame / 8) & 1;
+            HLC_BENCH(HLC_BENCH_DRAW_STATUS, {
+                draw_layer_number(number, number < 8 ? HLC_COLOR_LAYER_0 + number : HLC_COLOR_LAYER_UNDEF);
+                draw_indicator(LCD_HEIGHT - INDICATOR_HEIGHT * 3 - 15, caps, on, HLC_COLOR_CAPS_OFF, HLC_COLOR_CAPS_ON);
+                draw_indicator(LCD_HEIGHT - INDICATOR_HEIGHT * 2 - 10, num, !on, HLC_COLOR_NUM_OFF, HLC_COLOR_NUM_ON);
+                draw_indicator(LCD_HEIGHT - INDICATOR_HEIGHT - 5, scroll, on, HLC_COLOR_SCROLL_OFF, HLC_COLOR_SCROLL_ON);
+            });
+        }
+
+        HLC_BENCH(HLC_BENCH_FLUSH, flush_display(true));
     }
 
-    if(last_layer_state != layer_state || first_run_layer == false) {
-        switch (get_highest_layer(layer_state|default_layer_state)) {
-        case 0:
-            layer_number = qp_load_image_mem(gfx_0);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_0, HSV_BLACK);
-            break;
-        case 1:
-            layer_number = qp_load_image_mem(gfx_1);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_1, HSV_BLACK);
-            break;
-        case 2:
-            layer_number = qp_load_image_mem(gfx_2);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_2, HSV_BLACK);
-            break;
-        case 3:
-            layer_number = qp_load_image_mem(gfx_3);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_3, HSV_BLACK);
-            break;
-        case 4:
-            layer_number = qp_load_image_mem(gfx_4);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_4, HSV_BLACK);
+    hlc_bench_report(screen_crc());
+
+    // Back to the normal contents
+    clear_screen();
+    for (uint8_t y = 0; y < GRID_HEIGHT; y++) {
+        life_changed[y] = GRID_ROW_MASK;
+    }
+    first_run_led   = false;
+    first_run_layer = false;
+}
+#endif
+
+// Latest state of the keyboard, for the next frame
+static void poll_inputs(bool second_display) {
+    uint8_t layer = get_highest_layer(layer_state|default_layer_state);
+
+#ifdef HLC_TFT_CORE1
+    hlc_core1_set_input(HLC_CORE1_LED, host_keyboard_led_state().raw);
+    hlc_core1_set_input(HLC_CORE1_LAYER, layer);
+    hlc_core1_set_input(HLC_CORE1_ACTIVITY, last_matrix_activity_time());
+    hlc_core1_set_input(HLC_CORE1_SECOND_DISPLAY, second_display);
+#else
+    display_led_state     = host_keyboard_led_state();
+    display_layer         = layer;
+    display_activity_time = last_matrix_activity_time();
+    display_second        = second_display;
+#endif
+}
+
+#ifdef HLC_TFT_CORE1
+// Runs on core1, before it draws a frame
+static void apply_input(const hlc_msg_t *msg) {
+    switch (msg->type) {
+        case HLC_CORE1_LED:
+            display_led_state.raw = msg->value;
             break;
-        case 5:
-            layer_number = qp_load_image_mem(gfx_5);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_5, HSV_BLACK);
+        case HLC_CORE1_LAYER:
+            display_layer = msg->value;
             break;
-        case 6:
-            layer_number = qp_load_image_mem(gfx_6);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_6, HSV_BLACK);
+        case HLC_CORE1_ACTIVITY:
+            display_activity_time = msg->value;
             break;
-        case 7:
-            layer_number = qp_load_image_mem(gfx_7);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_7, HSV_BLACK);
+        case HLC_CORE1_SECOND_DISPLAY:
+            display_second = msg->value;
             break;
-        default:
-            layer_number = qp_load_image_mem(gfx_undef);
-            qp_drawimage_recolor(lcd_surface, 5, 5, layer_number, HSV_LAYER_UNDEF, HSV_BLACK);
+    }
+}
+#endif
+
+// Draws whatever changed into the framebuffer, runs on core1 with HLC_TFT_CORE1
+static void render_display(void) {
+    if(display_second) {
+        static systime_t last_draw = 0;
+        static bool second_display_set = false;
+
+        if(!second_display_set) {
+            srand(time(NULL));
+            init_grid();
+            color_value = rand() % 8;
+#ifdef HLC_TFT_STRIP_RENDER
+            hlc_strip_set_life(true, HLC_COLOR_LAYER_0 + color_value);
+#endif
+            second_display_set = true;
         }
-        qp_close_image(layer_number);
-        last_layer_state = layer_state;
-        first_run_layer = true;
+
+        if (chVTTimeElapsedSinceX(last_draw) >= TIME_MS2I(100) && life_frame_needed()) { // Throttle to 10 fps
+            hlc_sched_start(life_stages, ARRAY_SIZE(life_stages));
+            last_draw = chVTGetSystemTimeX();
+        }
+
+#ifdef HLC_TFT_CORE1
+        // Nothing else runs on core1, the frame is finished before core0 gets to send it
+        while (hlc_sched_run()) {
+            hlc_core1_yield();
+        }
+#else
+        // Does as much of the frame as the budget allows, the rest follows on the next ticks
+        hlc_sched_run();
+#endif
+    }
+
+    // Update display information (layers, numlock, etc.)
+    if(!display_second) {
+        HLC_BENCH(HLC_BENCH_UPDATE_DISPLAY, update_display());
     }
 }
 
 // Quantum function
 void suspend_power_down_kb(void) {
+    hlc_power_set_suspended(true);
+#ifdef HLC_TFT_ASYNC_FLUSH
+    hlc_spi_flush_wait();
+#endif
     qp_power(lcd, false);
     suspend_power_down_user();
 }
 
 // Quantum function
 void suspend_wakeup_init_kb(void) {
+#ifdef HLC_TFT_ASYNC_FLUSH
+    hlc_spi_flush_wait();
+#endif
     qp_power(lcd, true);
+    hlc_power_set_suspended(false);
     suspend_wakeup_init_user();
 }
 
+// Called from halcyon.c
+bool module_process_record_kb(uint16_t keycode, keyrecord_t *record) {
+    if (keycode == HLC_TFT_STATS_DUMP) {
+        if (record->event.pressed) {
+            hlc_dirty_dump();
+        }
+        return false;
+    }
+    return true;
+}
+
 // Called from halcyon.c
 bool module_post_init_kb(void) {
     setPinOutput(LCD_RST_PIN);
@@ -258,9 +540,20 @@ bool module_post_init_kb(void) {
     qp_init(lcd, LCD_ROTATION);
     qp_set_viewport_offsets(lcd, LCD_OFFSET_X, LCD_OFFSET_Y);
 
+#if !defined(HLC_TFT_INDEXED_FB) && !defined(HLC_TFT_STRIP_RENDER)
     // Initialise surface
     lcd_surface = qp_make_rgb565_surface(LCD_WIDTH, LCD_HEIGHT, lcd_surface_fb);
     qp_init(lcd_surface, LCD_ROTATION);
+#endif
+    hlc_raster_init_palette();
+    load_layer_numbers();
+
+#ifndef HLC_TFT_NATIVE_ASSETS
+    // Load fonts
+    Retron27 = qp_load_font_mem(font_Retron2000_27);
+    Retron27_underline = qp_load_font_mem(font_Retron2000_underline_27);
+#endif
+    load_indicators();
 
     // Turn on the LCD and clear the display
     qp_power(lcd, true);
@@ -270,6 +563,11 @@ bool module_post_init_kb(void) {
     // Turn on backlight
     backlight_enable();
 
+#ifdef HLC_TFT_CORE1
+    // Core0 keeps the framebuffer until its first flush, the user hook below may still draw
+    hlc_core1_start(apply_input, render_display);
+#endif
+
     if(!module_post_init_user()) { return false; }
 
     return true;
@@ -277,41 +575,62 @@ bool module_post_init_kb(void) {
 
 // Called from halcyon.c
 bool display_module_housekeeping_task_kb(bool second_display) {
-    if(!display_module_housekeeping_task_user(second_display)) { return false; }
+#ifdef HLC_TFT_ASYNC_FLUSH
+    // The framebuffer is still being sent, nothing (the user hook included) may draw into it yet
+    if (hlc_spi_flush_task()) {
+        return true;
+    }
+#endif
 
-    if(second_display) {
-        static uint32_t last_draw = 0;
-        static bool second_display_set = false;
-        static uint32_t previous_matrix_activity_time = 0;
+    poll_inputs(second_display);
 
-        if(!second_display_set) {
-            srand(time(NULL));
-            init_grid();
-            color_value = rand() % 8;
-            second_display_set = true;
-        }
+#ifdef HLC_TFT_CORE1
+    // The last frame is on the display, core1 can draw the next one
+    static bool frame_sent = false;
+    if (frame_sent) {
+        hlc_core1_release_frame();
+        frame_sent = false;
+    }
 
-        if (timer_elapsed32(last_draw) >= 100) { // Throttle to 10 fps
-            draw_grid();
-            update_grid();
+    // Core1 is drawing, the framebuffer comes back once its frame is complete
+    if (!hlc_core1_frame_ready()) {
+        return true;
+    }
+#endif
 
-            if (previous_matrix_activity_time != last_matrix_activity_time()) {
-                color_value = rand() % 8;
-                add_cell_cluster();
-                previous_matrix_activity_time = last_matrix_activity_time();
-            }
+    // Nothing can be seen with the backlight off or while suspended, the user hook is skipped as well
+    if (!hlc_power_task(backlight_off)) {
+        return true;
+    }
 
-            last_draw = timer_read32();
-        }
+#ifdef HLC_TFT_BENCH
+    static bool bench_done = false;
+    if (!bench_done && !hlc_sched_busy() && timer_read32() >= HLC_TFT_BENCH_DELAY) {
+        run_bench();
+        bench_done = true;
     }
+#endif
 
-    // Update display information (layers, numlock, etc.)
-    if(!second_display) {
-        update_display();
+    if(!display_module_housekeeping_task_user(second_display)) { return false; }
+
+    // Keep whatever the user hook drew, our own drawing marks its exact tiles
+    hlc_dirty_sync_surface(lcd_surface, true);
+
+#ifndef HLC_TFT_CORE1
+    render_display();
+
+    // Wait for the whole frame before showing it
+    if (hlc_sched_busy()) {
+        return true;
     }
+#endif
+
+    // Quantum Painter powers the display off from its own task, the bus has to be free by then
+    HLC_BENCH(HLC_BENCH_FLUSH, flush_display(last_input_activity_elapsed() + 1000 >= QUANTUM_PAINTER_DISPLAY_TIMEOUT));
 
-    // Move surface to lcd
-    qp_surface_draw(lcd_surface, lcd, 0, 0, 0);
+#ifdef HLC_TFT_CORE1
+    frame_sent = true;
+#endif
 
     return true;
 }
@@ -26,7 +26,7 @@
 #define HSV_LAYER_UNDEF 0, 255, 255
 
 extern painter_device_t lcd;
-extern painter_device_t lcd_surface;
+extern painter_device_t lcd_surface; // NULL with HLC_TFT_INDEXED_FB or HLC_TFT_STRIP_RENDER, there is no RGB565 framebuffer then
 
 void draw_grid(void);
 void update_grid(void);
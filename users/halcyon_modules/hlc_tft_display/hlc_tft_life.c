@@ -0,0 +1,160 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_life.h"
+#include "hlc_tft_display.h"
+
+#include <stdlib.h>
+
+// Define the probability factor for initial alive cells
+#define INITIAL_ALIVE_PROBABILITY 0.2  // 20% chance of being alive
+
+uint32_t life_grid[GRID_HEIGHT];
+uint32_t life_changed[GRID_HEIGHT];
+uint64_t life_active_rows;
+
+static uint32_t life_hashes[HLC_LIFE_PERIOD_MAX + 1]; // Hashes of the latest generations, newest first
+static uint8_t  life_hash_count = 0;                  // Generations in the history, reset whenever cells are added
+
+// A row can only change when it or one of its neighbours changed in the previous generation
+static inline uint64_t neighbour_rows(uint64_t rows) {
+    return (rows | (rows << 1) | (rows >> 1)) & GRID_ALL_ROWS;
+}
+
+// Adds three bit planes at once, every bit position is an independent adder
+static inline void full_add(uint32_t a, uint32_t b, uint32_t c, uint32_t *sum, uint32_t *carry) {
+    uint32_t half = a ^ b;
+    *sum          = half ^ c;
+    *carry        = (a & b) | (half & c);
+}
+
+// Computes the next state of a row from the (old) rows around it
+static inline uint32_t next_row(uint32_t above, uint32_t row, uint32_t below) {
+    uint32_t s_a, c_a, s_b, c_b, s0, c_d, t, c_e;
+
+    // Neighbours outside the grid are dead, the mask drops the bit shifted out on the left
+    full_add((above << 1) & GRID_ROW_MASK, above, above >> 1, &s_a, &c_a);
+    full_add((below << 1) & GRID_ROW_MASK, below, below >> 1, &s_b, &c_b);
+    uint32_t left  = (row << 1) & GRID_ROW_MASK;
+    uint32_t right = row >> 1;
+    uint32_t s_c   = left ^ right;
+    uint32_t c_c   = left & right;
+
+    // Neighbour count as bit planes s2:s1:s0 (a count of 8 wraps to 0, which is dead either way)
+    full_add(s_a, s_b, s_c, &s0, &c_d);
+    full_add(c_a, c_b, c_c, &t, &c_e);
+    uint32_t s1 = t ^ c_d;
+    uint32_t s2 = c_e ^ (t & c_d);
+
+    // Alive with 2 or 3 neighbours, or dead with exactly 3
+    return s1 & ~s2 & (s0 | row);
+}
+
+void init_grid() {
+    // Initialize grid with alive cells
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+        uint32_t row = 0;
+        for (int x = 0; x < GRID_WIDTH; x++) {
+            if (rand() < INITIAL_ALIVE_PROBABILITY * RAND_MAX) { // Use probability factor
+                row |= 1UL << x;
+            }
+        }
+        life_grid[y]    = row;
+        life_changed[y] = GRID_ROW_MASK; // Mark all as changed initially
+    }
+    life_active_rows = GRID_ALL_ROWS;
+    life_hash_count  = 0;
+}
+
+// Keeps the hash of a finished generation
+static void push_hash(uint32_t hash) {
+    for (uint8_t i = HLC_LIFE_PERIOD_MAX; i > 0; i--) {
+        life_hashes[i] = life_hashes[i - 1];
+    }
+    life_hashes[0] = hash;
+    if (life_hash_count <= HLC_LIFE_PERIOD_MAX) {
+        life_hash_count++;
+    }
+}
+
+// Period of the grid when the latest generation repeats one of the previous HLC_LIFE_PERIOD_MAX, 0 while it is still evolving
+uint8_t life_period(void) {
+    if (life_active_rows == 0 && life_hash_count > 0) {
+        return 1; // Still life, nothing can change anymore
+    }
+    for (uint8_t period = 1; period < life_hash_count; period++) {
+        if (life_hashes[period] == life_hashes[0]) {
+            return period;
+        }
+    }
+    return 0;
+}
+
+// Steps rows [y, y + count) to the next generation, rows have to be stepped in order starting at 0.
+// Rows that can't change are skipped. Returns the row to continue from, GRID_HEIGHT once the whole grid is done.
+uint8_t update_grid_rows(uint8_t y, uint8_t count) {
+    static uint32_t above;        // Old state of the previous row, it is overwritten in place
+    static uint64_t changed_rows; // Rows that changed in this generation so far
+    static uint32_t hash;         // Rolling hash of the new generation
+    uint8_t         end = (y + count < GRID_HEIGHT) ? y + count : GRID_HEIGHT;
+
+    if (y == 0) {
+        above        = 0;
+        changed_rows = 0;
+        hash         = 2166136261UL;
+    }
+
+    for (; y < end; y++) {
+        uint32_t row = life_grid[y];
+
+        if (!(life_active_rows & (1ULL << y))) {
+            life_changed[y] = 0;
+            above           = row;
+            hash            = (hash ^ row) * 16777619UL;
+            continue;
+        }
+
+        uint32_t below = (y + 1 < GRID_HEIGHT) ? life_grid[y + 1] : 0;
+        uint32_t next  = next_row(above, row, below);
+
+        life_changed[y] = row ^ next;
+        life_grid[y]    = next;
+        above           = row;
+        hash            = (hash ^ next) * 16777619UL;
+        if (row != next) {
+            changed_rows |= 1ULL << y;
+        }
+    }
+
+    if (y == GRID_HEIGHT) {
+        life_active_rows = neighbour_rows(changed_rows);
+        push_hash(hash);
+    }
+
+    return y;
+}
+
+void update_grid() {
+    update_grid_rows(0, GRID_HEIGHT);
+}
+
+// Function to add a cluster of cells at a random position
+void add_cell_cluster() {
+    int cluster_size = 3;  // Size of the cluster (3x3)
+    int x = rand() % (GRID_WIDTH - cluster_size);
+    int y = rand() % (GRID_HEIGHT - cluster_size);
+
+    for (int dy = 0; dy < cluster_size; dy++) {
+        for (int dx = 0; dx < cluster_size; dx++) {
+            uint32_t bit = 1UL << (x + dx);
+            if (rand() % 2) { // Randomly choose between 0 and 1
+                life_grid[y + dy] |= bit;
+            } else {
+                life_grid[y + dy] &= ~bit;
+            }
+            life_changed[y + dy] |= bit; // Mark the cell as changed
+        }
+    }
+    life_active_rows |= neighbour_rows(((1ULL << cluster_size) - 1) << y);
+    life_hash_count = 0;
+}
@@ -0,0 +1,32 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+#define GRID_WIDTH 27
+#define GRID_HEIGHT 48
+#define GRID_ROW_MASK ((1UL << GRID_WIDTH) - 1)
+#define GRID_ALL_ROWS ((1ULL << GRID_HEIGHT) - 1)
+
+// Longest oscillator period that is recognised as a settled grid
+#ifndef HLC_LIFE_PERIOD_MAX
+#    define HLC_LIFE_PERIOD_MAX 3
+#endif
+
+// Adds new cells once the grid has been settled for this many milliseconds, 0 waits for a key press instead
+#ifndef HLC_LIFE_RESEED_TIMEOUT
+#    define HLC_LIFE_RESEED_TIMEOUT 0
+#endif
+
+_Static_assert(GRID_WIDTH <= 32, "A grid row has to fit in a uint32_t");
+_Static_assert(GRID_HEIGHT <= 64, "Row activity is kept in a uint64_t");
+
+// One word per row, bit x is column x
+extern uint32_t life_grid[GRID_HEIGHT];    // Current state
+extern uint32_t life_changed[GRID_HEIGHT]; // Cells that changed since the last draw
+extern uint64_t life_active_rows;          // Bit y is set when row y can change in the next generation
+
+uint8_t update_grid_rows(uint8_t y, uint8_t count);
+uint8_t life_period(void);
@@ -0,0 +1,55 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_power.h"
+#include "hlc_tft_dirty.h"
+
+#include "timer.h"
+#include "debug.h"
+
+static hlc_power_state_t power_state = HLC_POWER_ON;
+static bool              suspended   = false;
+static uint32_t          paused_since;
+static hlc_power_stats_t power_stats;
+
+// Called from the suspend hooks, the next task call switches the state
+void hlc_power_set_suspended(bool value) {
+    suspended = value;
+}
+
+// Follows the backlight and suspend state, returns false while the display work has to be skipped
+bool hlc_power_task(bool backlight_off) {
+    hlc_power_state_t next = suspended ? HLC_POWER_SUSPENDED : (backlight_off ? HLC_POWER_IDLE : HLC_POWER_ON);
+
+    if (next != power_state) {
+        if (power_state == HLC_POWER_ON) {
+            paused_since = timer_read32();
+        } else if (next == HLC_POWER_ON) {
+            // Whatever changed in the meantime is drawn once, in a single full redraw
+            uint32_t paused = timer_elapsed32(paused_since);
+            power_stats.paused_ms += paused;
+            power_stats.resumes++;
+            hlc_dirty_mark_all();
+            dprintf("hlc_tft: resumed after %lu ms, %lu ticks skipped\n", paused, power_stats.ticks_skipped);
+        }
+        power_state = next;
+    }
+
+    if (power_state != HLC_POWER_ON) {
+        power_stats.ticks_skipped++;
+        if (hlc_dirty_pending()) {
+            power_stats.flushes_skipped++;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+hlc_power_state_t hlc_power_get_state(void) {
+    return power_state;
+}
+
+const hlc_power_stats_t *hlc_power_get_stats(void) {
+    return &power_stats;
+}
@@ -0,0 +1,26 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Nothing is rendered or sent while the display can't be seen
+typedef enum {
+    HLC_POWER_ON,        // Rendering and flushing as usual
+    HLC_POWER_IDLE,      // Backlight timed out
+    HLC_POWER_SUSPENDED, // USB suspend, the panel is powered off
+} hlc_power_state_t;
+
+typedef struct {
+    uint32_t ticks_skipped;   // Housekeeping ticks that did no display work
+    uint32_t flushes_skipped; // Of those, ticks that had dirty tiles waiting
+    uint32_t paused_ms;       // Time spent idle or suspended, up to the last resume
+    uint32_t resumes;         // Full redraws after waking up
+} hlc_power_stats_t;
+
+void              hlc_power_set_suspended(bool suspended);
+bool              hlc_power_task(bool backlight_off);
+hlc_power_state_t hlc_power_get_state(void);
+const hlc_power_stats_t *hlc_power_get_stats(void);
@@ -0,0 +1,109 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_raster.h"
+#include "hlc_tft_display.h"
+
+#include "util.h"
+
+hlc_pixel_t hlc_palette[HLC_COLOR_COUNT];
+uint16_t    hlc_palette_native[HLC_COLOR_COUNT];
+
+const hsv_t hlc_palette_hsv[HLC_COLOR_COUNT] = {
+    [HLC_COLOR_BLACK]       = {HSV_BLACK},
+    [HLC_COLOR_LAYER_0]     = {HSV_LAYER_0},
+    [HLC_COLOR_LAYER_1]     = {HSV_LAYER_1},
+    [HLC_COLOR_LAYER_2]     = {HSV_LAYER_2},
+    [HLC_COLOR_LAYER_3]     = {HSV_LAYER_3},
+    [HLC_COLOR_LAYER_4]     = {HSV_LAYER_4},
+    [HLC_COLOR_LAYER_5]     = {HSV_LAYER_5},
+    [HLC_COLOR_LAYER_6]     = {HSV_LAYER_6},
+    [HLC_COLOR_LAYER_7]     = {HSV_LAYER_7},
+    [HLC_COLOR_LAYER_UNDEF] = {HSV_LAYER_UNDEF},
+    [HLC_COLOR_CAPS_OFF]    = {HSV_CAPS_OFF},
+    [HLC_COLOR_CAPS_ON]     = {HSV_CAPS_ON},
+    [HLC_COLOR_NUM_OFF]     = {HSV_NUM_OFF},
+    [HLC_COLOR_NUM_ON]      = {HSV_NUM_ON},
+    [HLC_COLOR_SCROLL_OFF]  = {HSV_SCROLL_OFF},
+    [HLC_COLOR_SCROLL_ON]   = {HSV_SCROLL_ON},
+};
+
+// Same conversion Quantum Painter uses for RGB565 surfaces, so output stays pixel identical
+void hlc_raster_init_palette(void) {
+    for (uint8_t i = 0; i < HLC_COLOR_COUNT; i++) {
+        rgb_t    rgb          = hsv_to_rgb_nocie(hlc_palette_hsv[i]);
+        uint16_t rgb565       = (((uint16_t)rgb.r) >> 3) << 11 | (((uint16_t)rgb.g) >> 2) << 5 | (((uint16_t)rgb.b) >> 3);
+        hlc_palette_native[i] = __builtin_bswap16(rgb565);
+#ifdef HLC_TFT_INDEXED_FB
+        hlc_palette[i] = i;
+#else
+        hlc_palette[i] = hlc_palette_native[i];
+#endif
+    }
+}
+
+// Converts framebuffer pixels to what the display expects
+void hlc_raster_expand(uint16_t *native, const hlc_pixel_t *pixels, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        native[i] = hlc_palette_native[pixels[i]];
+    }
+}
+
+void hlc_raster_fill(const hlc_canvas_t *canvas, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, hlc_pixel_t color) {
+    uint16_t canvas_bottom = canvas->top + canvas->height - 1;
+
+    if (top > canvas_bottom || bottom < canvas->top || left >= canvas->width) {
+        return;
+    }
+    top    = MAX(top, canvas->top);
+    bottom = MIN(bottom, canvas_bottom);
+    right  = MIN(right, canvas->width - 1);
+
+    for (uint16_t y = top; y <= bottom; y++) {
+        hlc_pixel_t *pixel = &canvas->buffer[(y - canvas->top) * canvas->width + left];
+        for (uint16_t x = left; x <= right; x++) {
+            *pixel++ = color;
+        }
+    }
+}
+
+// Writes the 5 pixels of one cell row, using a single store for aligned pixel pairs
+static inline void cell_span(hlc_pixel_t *pixel, hlc_pixel_t fill) {
+    hlc_pixel_t black = hlc_palette[HLC_COLOR_BLACK];
+
+    if (HLC_PIXEL_PAIR_ALIGNED(pixel)) {
+        hlc_pixel_pair_t *pair = (hlc_pixel_pair_t *)pixel;
+        pair[0]                = HLC_PIXEL_PAIR(black, fill);
+        pair[1]                = HLC_PIXEL_PAIR(fill, fill);
+        pixel[4]               = fill;
+    } else {
+        pixel[0]               = black;
+        hlc_pixel_pair_t *pair = (hlc_pixel_pair_t *)&pixel[1];
+        pair[0]                = HLC_PIXEL_PAIR(fill, fill);
+        pair[1]                = HLC_PIXEL_PAIR(fill, fill);
+    }
+}
+
+// Redraws the changed cells of one grid row in a single pass
+void hlc_raster_life_row(const hlc_canvas_t *canvas, uint8_t y, uint32_t changed, uint32_t alive, hlc_pixel_t color) {
+    hlc_pixel_t black = hlc_palette[HLC_COLOR_BLACK];
+    uint16_t    top   = y * HLC_CELL_PITCH;
+
+    for (uint16_t py = top; py < top + HLC_CELL_PITCH; py++) {
+        if (py < canvas->top || py >= canvas->top + canvas->height) {
+            continue;
+        }
+
+        hlc_pixel_t *row  = &canvas->buffer[(py - canvas->top) * canvas->width];
+        uint32_t     bits = changed;
+
+        while (bits) {
+            uint8_t x = __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            // Top outline row is black, as are dead cells
+            hlc_pixel_t fill = (py != top && (alive & (1UL << x))) ? color : black;
+            cell_span(&row[x * HLC_CELL_PITCH], fill);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "color.h"
+
+// Colours used by the display, converted once to the native (byte swapped) RGB565 format of the ST7789
+typedef enum hlc_color {
+    HLC_COLOR_BLACK,
+    HLC_COLOR_LAYER_0,
+    HLC_COLOR_LAYER_1,
+    HLC_COLOR_LAYER_2,
+    HLC_COLOR_LAYER_3,
+    HLC_COLOR_LAYER_4,
+    HLC_COLOR_LAYER_5,
+    HLC_COLOR_LAYER_6,
+    HLC_COLOR_LAYER_7,
+    HLC_COLOR_LAYER_UNDEF,
+    HLC_COLOR_CAPS_OFF,
+    HLC_COLOR_CAPS_ON,
+    HLC_COLOR_NUM_OFF,
+    HLC_COLOR_NUM_ON,
+    HLC_COLOR_SCROLL_OFF,
+    HLC_COLOR_SCROLL_ON,
+    HLC_COLOR_COUNT
+} hlc_color_t;
+
+#ifdef HLC_TFT_INDEXED_FB
+// One palette index per pixel, expanded to RGB565 while flushing
+typedef uint8_t hlc_pixel_t;
+typedef uint16_t __attribute__((may_alias)) hlc_pixel_pair_t;
+#else
+// Native RGB565, sent to the display as is
+typedef uint16_t hlc_pixel_t;
+typedef uint32_t __attribute__((may_alias)) hlc_pixel_pair_t;
+#endif
+
+// Two neighbouring pixels in a single store, the pointer has to be aligned to a pair
+#define HLC_PIXEL_PAIR(first, second) ((hlc_pixel_pair_t)(first) | ((hlc_pixel_pair_t)(second) << (8 * sizeof(hlc_pixel_t))))
+#define HLC_PIXEL_PAIR_ALIGNED(pixel) (((uintptr_t)(pixel) & sizeof(hlc_pixel_t)) == 0)
+
+extern const hsv_t hlc_palette_hsv[HLC_COLOR_COUNT];
+extern hlc_pixel_t hlc_palette[HLC_COLOR_COUNT];        // Framebuffer value of each colour
+extern uint16_t    hlc_palette_native[HLC_COLOR_COUNT]; // Native RGB565 of each colour
+
+// Life cells are a 4x4 fill with a 1 pixel outline on the top and left
+#define HLC_CELL_PITCH 5
+
+// A horizontal band of the screen, rows [top, top + height)
+typedef struct {
+    hlc_pixel_t *buffer;
+    uint16_t  width;
+    uint16_t  top;
+    uint16_t  height;
+} hlc_canvas_t;
+
+void hlc_raster_init_palette(void);
+void hlc_raster_fill(const hlc_canvas_t *canvas, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, hlc_pixel_t color);
+void hlc_raster_life_row(const hlc_canvas_t *canvas, uint8_t y, uint32_t changed, uint32_t alive, hlc_pixel_t color);
+void hlc_raster_expand(uint16_t *native, const hlc_pixel_t *pixels, uint32_t count);
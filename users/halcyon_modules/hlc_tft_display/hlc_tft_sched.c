@@ -0,0 +1,66 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_sched.h"
+
+#include <stddef.h>
+#include "ch.h"
+
+static const hlc_sched_stage_t *frame_stages;
+static uint8_t                  frame_count;
+static uint8_t                  frame_stage;
+static bool                     tick_seen = false;
+static systime_t                last_tick;
+static hlc_sched_stats_t        sched_stats;
+
+// Queues a frame made of stages that run in order, a frame that is due while another one is running is dropped
+bool hlc_sched_start(const hlc_sched_stage_t *stages, uint8_t count) {
+    if (hlc_sched_busy()) {
+        sched_stats.frames_skipped++;
+        return false;
+    }
+
+    frame_stages = stages;
+    frame_count  = count;
+    frame_stage  = 0;
+    return true;
+}
+
+// Runs slices of the current frame until it is done or the budget of this tick is spent, returns true while work is left
+bool hlc_sched_run(void) {
+    systime_t start = chVTGetSystemTimeX();
+    bool      late  = tick_seen && TIME_I2US(chTimeDiffX(last_tick, start)) > HLC_SCHED_LATE_US;
+
+    last_tick = start;
+    tick_seen = true;
+
+    if (late && hlc_sched_busy()) {
+        sched_stats.late_ticks++;
+    }
+
+    while (hlc_sched_busy()) {
+        if (frame_stages[frame_stage]()) {
+            if (++frame_stage == frame_count) {
+                sched_stats.frames++;
+            }
+        }
+        if (late || TIME_I2US(chVTTimeElapsedSinceX(start)) >= HLC_SCHED_BUDGET_US) {
+            break;
+        }
+    }
+
+    uint32_t spent = TIME_I2US(chVTTimeElapsedSinceX(start));
+    if (spent > sched_stats.max_tick_us) {
+        sched_stats.max_tick_us = spent;
+    }
+
+    return hlc_sched_busy();
+}
+
+bool hlc_sched_busy(void) {
+    return frame_stages != NULL && frame_stage < frame_count;
+}
+
+const hlc_sched_stats_t *hlc_sched_get_stats(void) {
+    return &sched_stats;
+}
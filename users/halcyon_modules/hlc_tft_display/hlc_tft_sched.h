@@ -0,0 +1,37 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Time a housekeeping tick may spend on rendering, the first slice of a tick always runs
+#ifndef HLC_SCHED_BUDGET_US
+#    define HLC_SCHED_BUDGET_US 1000
+#endif
+
+// A tick that arrives later than this after the previous one means the scan loop is behind, only the first slice runs then
+#ifndef HLC_SCHED_LATE_US
+#    define HLC_SCHED_LATE_US 5000
+#endif
+
+// Grid rows handled by a single slice of the Life stages
+#ifndef HLC_SCHED_ROWS_PER_SLICE
+#    define HLC_SCHED_ROWS_PER_SLICE 8
+#endif
+
+// Runs one slice of a stage, returns true once the stage is complete
+typedef bool (*hlc_sched_stage_t)(void);
+
+typedef struct {
+    uint32_t frames;         // Frames that ran all their stages
+    uint32_t frames_skipped; // Frames dropped because the previous one was still running
+    uint32_t late_ticks;     // Ticks that only got the first slice because the loop was late
+    uint32_t max_tick_us;    // Longest time spent in a single tick
+} hlc_sched_stats_t;
+
+bool hlc_sched_start(const hlc_sched_stage_t *stages, uint8_t count);
+bool hlc_sched_run(void);
+bool hlc_sched_busy(void);
+const hlc_sched_stats_t *hlc_sched_get_stats(void);
@@ -0,0 +1,183 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_spi.h"
+#ifdef HLC_TFT_STRIP_RENDER
+#    include "hlc_tft_strip.h"
+#endif
+
+#include <stddef.h>
+#include <string.h>
+#include "util.h"
+#include "gpio.h"
+#include "spi_master.h"
+
+#ifdef HLC_TFT_STRIP_RENDER
+// The renderer produces full width rows, dirty tile rows are sent as full width bands
+#    define SPI_MAX_WINDOWS HLC_DIRTY_MAX_BANDS
+#else
+#    define SPI_MAX_WINDOWS HLC_DIRTY_MAX_RECTS
+#endif
+
+static struct {
+    painter_device_t   target;
+    const hlc_pixel_t *framebuffer;
+    hlc_rect_t         windows[SPI_MAX_WINDOWS];
+    uint8_t            count;
+    uint8_t            next;
+    const hlc_rect_t  *window;  // Window that is open
+    uint16_t           row;     // First row of the window that hasn't been handed to the DMA yet
+    bool               sending; // A DMA transfer owns the SPI bus
+    uint8_t            buffer;  // Chunk buffer holding the rows starting at row
+} flush;
+
+// Rows that aren't a contiguous run of the framebuffer are gathered (expanded, rendered) into these first.
+// Each one holds HLC_SPI_CHUNK_ROWS full width rows, or more rows of a narrower window.
+static uint16_t chunks[2][HLC_SPI_CHUNK_ROWS * LCD_WIDTH] __attribute__((aligned(4)));
+
+static inline uint16_t window_width(void) {
+    return flush.window->r - flush.window->l + 1;
+}
+
+static uint16_t chunk_rows(uint16_t row) {
+    uint16_t fit = ARRAY_SIZE(chunks[0]) / window_width();
+    return MIN(fit, flush.window->b + 1 - row);
+}
+
+static void prepare_chunk(uint8_t buffer, uint16_t row) {
+    if (row > flush.window->b) {
+        return;
+    }
+#ifdef HLC_TFT_STRIP_RENDER
+    hlc_strip_render(chunks[buffer], row, chunk_rows(row));
+#else
+    uint16_t  width = window_width();
+    uint16_t *chunk = chunks[buffer];
+    for (uint16_t y = row; y < row + chunk_rows(row); y++, chunk += width) {
+        const hlc_pixel_t *pixels = &flush.framebuffer[y * LCD_WIDTH + flush.window->l];
+#    ifdef HLC_TFT_INDEXED_FB
+        hlc_raster_expand(chunk, pixels, width);
+#    else
+        memcpy(chunk, pixels, width * sizeof(uint16_t));
+#    endif
+    }
+#endif
+}
+
+// Native full width windows are a single run of the framebuffer, they go out without a copy
+static inline bool window_direct(void) {
+#if defined(HLC_TFT_INDEXED_FB) || defined(HLC_TFT_STRIP_RENDER)
+    return false;
+#else
+    return window_width() == LCD_WIDTH;
+#endif
+}
+
+// Opens the window through Quantum Painter, then streams its rows as raw pixel data behind its back
+static bool open_window(const hlc_rect_t *window) {
+    if (!qp_viewport(flush.target, window->l, window->t, window->r, window->b)) {
+        return false;
+    }
+    if (!spi_start(LCD_CS_PIN, false, LCD_SPI_MODE, LCD_SPI_DIVISOR)) {
+        return false;
+    }
+
+    writePinHigh(LCD_DC_PIN);
+    flush.window = window;
+    flush.row    = window->t;
+    flush.buffer = 0;
+    if (!window_direct()) {
+        prepare_chunk(0, window->t);
+    }
+    return true;
+}
+
+// Hands the next part of the open window to the DMA, returns false once the whole window went out
+static bool send_next(void) {
+    if (flush.row > flush.window->b) {
+        return false;
+    }
+
+    if (window_direct()) {
+        // The whole window goes out in one transfer
+        uint16_t rows = flush.window->b + 1 - flush.row;
+        spiStartSend(&SPI_DRIVER, (size_t)rows * LCD_WIDTH * sizeof(uint16_t), &flush.framebuffer[flush.row * LCD_WIDTH]);
+        flush.row += rows;
+    } else {
+        uint16_t rows = chunk_rows(flush.row);
+        spiStartSend(&SPI_DRIVER, (size_t)rows * window_width() * sizeof(uint16_t), chunks[flush.buffer]);
+        flush.row += rows;
+
+        // Prepare the following rows while these are being sent
+        flush.buffer ^= 1;
+        prepare_chunk(flush.buffer, flush.row);
+    }
+
+    flush.sending = true;
+    return true;
+}
+
+bool hlc_spi_flush_start(painter_device_t surface, painter_device_t target, const hlc_pixel_t *framebuffer) {
+    if (hlc_spi_flush_in_progress()) {
+        return false;
+    }
+
+    hlc_dirty_sync_surface(surface, true);
+
+#ifdef HLC_TFT_STRIP_RENDER
+    flush.count = hlc_dirty_plan_bands(flush.windows);
+#else
+    flush.count = hlc_dirty_plan(flush.windows);
+#endif
+    if (flush.count == 0) {
+        return true;
+    }
+
+    flush.target      = target;
+    flush.framebuffer = framebuffer;
+    flush.next        = 0;
+    hlc_dirty_commit(flush.windows, flush.count);
+
+    hlc_spi_flush_task();
+    return true;
+}
+
+// Keeps the DMA fed once the previous transfer is done, returns true while there is still work left
+bool hlc_spi_flush_task(void) {
+    while (!flush.sending || SPI_DRIVER.state == SPI_READY) {
+        flush.sending = false;
+
+        if (flush.window != NULL) {
+            // A chunk that is already out is followed right away instead of on the next housekeeping tick
+            if (send_next()) {
+                continue;
+            }
+            spi_stop();
+            flush.window = NULL;
+        }
+
+        if (flush.next >= flush.count) {
+            break;
+        }
+
+        if (!open_window(&flush.windows[flush.next++])) {
+            // Bus is taken by someone else, drop the rest of the frame and redraw it later
+            for (uint8_t i = flush.next - 1; i < flush.count; i++) {
+                hlc_dirty_mark(flush.windows[i].l, flush.windows[i].t, flush.windows[i].r, flush.windows[i].b);
+            }
+            flush.count = 0;
+            break;
+        }
+    }
+
+    return hlc_spi_flush_in_progress();
+}
+
+bool hlc_spi_flush_in_progress(void) {
+    return flush.window != NULL || flush.next < flush.count;
+}
+
+void hlc_spi_flush_wait(void) {
+    while (hlc_spi_flush_task()) {
+    }
+}
@@ -0,0 +1,26 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "qp.h"
+#include "hlc_tft_dirty.h"
+
+// Full width rows per DMA transfer when they have to be gathered (windows narrower than the display), expanded
+// (indexed framebuffer) or rendered (strip renderer) first. Two buffers of this size are used, one is filled while the
+// other is sent.
+#ifndef HLC_SPI_CHUNK_ROWS
+#    ifdef HLC_TFT_STRIP_RENDER
+#        define HLC_SPI_CHUNK_ROWS 16
+#    else
+#        define HLC_SPI_CHUNK_ROWS 8
+#    endif
+#endif
+
+// Sends the dirty windows of the framebuffer (full width bands with the strip renderer) with DMA while the main loop
+// carries on.
+// The framebuffer (or the display list of the strip renderer) must not change while hlc_spi_flush_in_progress() returns true.
+bool hlc_spi_flush_start(painter_device_t surface, painter_device_t target, const hlc_pixel_t *framebuffer);
+bool hlc_spi_flush_task(void);
+bool hlc_spi_flush_in_progress(void);
+void hlc_spi_flush_wait(void);
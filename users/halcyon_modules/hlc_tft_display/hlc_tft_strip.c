@@ -0,0 +1,66 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_strip.h"
+#include "hlc_tft_dirty.h"
+#include "hlc_tft_life.h"
+
+#include <stddef.h>
+#include "util.h"
+
+#ifdef HLC_TFT_INDEXED_FB
+#    error "The strip renderer produces RGB565 strips, it can not be combined with HLC_TFT_INDEXED_FB"
+#endif
+
+static struct {
+    const hlc_asset_t *asset;
+    uint16_t           x;
+    uint16_t           y;
+} items[HLC_STRIP_ITEMS];
+
+static bool        life_enabled = false;
+static hlc_color_t life_color;
+
+static void mark_item(hlc_strip_item_t item) {
+    if (items[item].asset != NULL) {
+        hlc_dirty_mark(items[item].x, items[item].y, items[item].x + items[item].asset->width - 1, items[item].y + items[item].asset->height - 1);
+    }
+}
+
+// Replaces an item, both the old and the new area get redrawn
+void hlc_strip_set_item(hlc_strip_item_t item, const hlc_asset_t *asset, uint16_t x, uint16_t y) {
+    mark_item(item);
+    items[item].asset = asset;
+    items[item].x     = x;
+    items[item].y     = y;
+    mark_item(item);
+}
+
+// The cells are read from life_grid while rendering, changes are marked dirty by the caller
+void hlc_strip_set_life(bool enabled, hlc_color_t color) {
+    if (enabled != life_enabled) {
+        hlc_dirty_mark_all();
+    }
+    life_enabled = enabled;
+    life_color   = color;
+}
+
+// Renders screen rows [top, top + rows) into a buffer of full width rows
+void hlc_strip_render(uint16_t *buffer, uint16_t top, uint16_t rows) {
+    hlc_canvas_t canvas = {buffer, LCD_WIDTH, top, rows};
+
+    if (life_enabled) {
+        // The cells cover the whole screen, no need to clear it first
+        for (uint8_t y = top / HLC_CELL_PITCH; y < GRID_HEIGHT && y * HLC_CELL_PITCH < top + rows; y++) {
+            hlc_raster_life_row(&canvas, y, GRID_ROW_MASK, life_grid[y], hlc_palette[life_color]);
+        }
+    } else {
+        hlc_raster_fill(&canvas, 0, top, LCD_WIDTH - 1, top + rows - 1, hlc_palette[HLC_COLOR_BLACK]);
+    }
+
+    for (uint8_t i = 0; i < HLC_STRIP_ITEMS; i++) {
+        if (items[i].asset != NULL) {
+            hlc_asset_blit(&canvas, items[i].asset, items[i].x, items[i].y);
+        }
+    }
+}
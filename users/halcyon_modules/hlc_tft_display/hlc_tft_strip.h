@@ -0,0 +1,19 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "hlc_tft_assets.h"
+
+// Retained display list for the strip renderer, the screen is rendered from it one strip at a time while flushing
+typedef enum {
+    HLC_STRIP_LAYER,
+    HLC_STRIP_CAPS,
+    HLC_STRIP_NUM,
+    HLC_STRIP_SCROLL,
+    HLC_STRIP_ITEMS
+} hlc_strip_item_t;
+
+void hlc_strip_set_item(hlc_strip_item_t item, const hlc_asset_t *asset, uint16_t x, uint16_t y);
+void hlc_strip_set_life(bool enabled, hlc_color_t color);
+void hlc_strip_render(uint16_t *buffer, uint16_t top, uint16_t rows);
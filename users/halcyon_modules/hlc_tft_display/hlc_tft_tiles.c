@@ -0,0 +1,111 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hlc_tft_tiles.h"
+
+#include <stddef.h>
+#include "util.h"
+
+typedef struct {
+    const char           *text;
+    painter_font_handle_t font;
+    hlc_color_t           fg;
+    hlc_color_t           bg;
+    hlc_tile_t            tile;
+} text_tile_t;
+
+static text_tile_t text_cache[HLC_TEXT_CACHE_SIZE];
+static uint8_t     text_cache_used = 0;
+
+static uint8_t  tile_pool[HLC_TILE_POOL_SIZE + 1]; // Extra byte so the blitter can always read two bytes
+static uint16_t tile_pool_used = 0;
+
+// Reads back a rectangle of the canvas into a mask, every pixel that isn't the background is set
+bool hlc_tile_capture(hlc_tile_t *tile, const hlc_canvas_t *canvas, uint16_t x, uint16_t y, uint16_t width, uint16_t height, hlc_pixel_t bg) {
+    uint16_t stride = (width + 7) / 8;
+    uint32_t size   = (uint32_t)stride * height;
+
+    if (tile_pool_used + size > HLC_TILE_POOL_SIZE || y < canvas->top || y + height > canvas->top + canvas->height || x + width > canvas->width) {
+        tile->mask = NULL;
+        return false;
+    }
+
+    uint8_t *mask = &tile_pool[tile_pool_used];
+    tile_pool_used += size;
+
+    for (uint16_t row = 0; row < height; row++) {
+        const hlc_pixel_t *pixel = &canvas->buffer[(y + row - canvas->top) * canvas->width + x];
+        uint8_t        *bits  = &mask[row * stride];
+        for (uint16_t col = 0; col < width; col++) {
+            if (pixel[col] != bg) {
+                bits[col / 8] |= 1 << (col % 8);
+            }
+        }
+    }
+
+    tile->width  = width;
+    tile->height = height;
+    tile->mask   = mask;
+    return true;
+}
+
+// Expands a mask into the canvas, two pixels per store through a four entry lookup table
+void hlc_tile_blit(const hlc_canvas_t *canvas, const hlc_tile_t *tile, uint16_t x, uint16_t y, hlc_pixel_t fg, hlc_pixel_t bg) {
+    const hlc_pixel_pair_t pairs[4] = {
+        HLC_PIXEL_PAIR(bg, bg),
+        HLC_PIXEL_PAIR(fg, bg),
+        HLC_PIXEL_PAIR(bg, fg),
+        HLC_PIXEL_PAIR(fg, fg),
+    };
+    uint16_t stride = (tile->width + 7) / 8;
+    uint16_t first  = MAX(y, canvas->top);
+    uint16_t last   = MIN(y + tile->height, canvas->top + canvas->height);
+    uint16_t width  = MIN(tile->width, canvas->width - x);
+
+    for (uint16_t py = first; py < last; py++) {
+        const uint8_t *bits  = &tile->mask[(py - y) * stride];
+        hlc_pixel_t   *pixel = &canvas->buffer[(py - canvas->top) * canvas->width + x];
+        uint16_t       col   = 0;
+
+        if (!HLC_PIXEL_PAIR_ALIGNED(pixel)) {
+            *pixel++ = (bits[0] & 1) ? fg : bg;
+            col++;
+        }
+        for (; col + 1 < width; col += 2) {
+            uint16_t window = bits[col / 8] | (bits[col / 8 + 1] << 8);
+            *(hlc_pixel_pair_t *)pixel = pairs[(window >> (col % 8)) & 3];
+            pixel += 2;
+        }
+        if (col < width) {
+            *pixel = (bits[col / 8] & (1 << (col % 8))) ? fg : bg;
+        }
+    }
+}
+
+// Draws a string from the cache, on a miss it is rendered by Quantum Painter once and read back
+int16_t hlc_text_draw(const hlc_canvas_t *canvas, painter_device_t surface, uint16_t x, uint16_t y, painter_font_handle_t font, const char *text, hlc_color_t fg, hlc_color_t bg) {
+    for (uint8_t i = 0; i < text_cache_used; i++) {
+        const text_tile_t *entry = &text_cache[i];
+        if (entry->text == text && entry->font == font && entry->fg == fg && entry->bg == bg) {
+            hlc_tile_blit(canvas, &entry->tile, x, y, hlc_palette[fg], hlc_palette[bg]);
+            return entry->tile.width;
+        }
+    }
+
+    const hsv_t *fg_hsv = &hlc_palette_hsv[fg];
+    const hsv_t *bg_hsv = &hlc_palette_hsv[bg];
+    int16_t      width  = qp_drawtext_recolor(surface, x, y, font, text, fg_hsv->h, fg_hsv->s, fg_hsv->v, bg_hsv->h, bg_hsv->s, bg_hsv->v);
+
+    if (width > 0 && text_cache_used < HLC_TEXT_CACHE_SIZE) {
+        text_tile_t *entry = &text_cache[text_cache_used];
+        if (hlc_tile_capture(&entry->tile, canvas, x, y, width, font->line_height, hlc_palette[bg])) {
+            entry->text = text;
+            entry->font = font;
+            entry->fg   = fg;
+            entry->bg   = bg;
+            text_cache_used++;
+        }
+    }
+
+    return width;
+}
@@ -0,0 +1,28 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "qp.h"
+#include "hlc_tft_raster.h"
+
+// Room for the pre-decoded masks, one bit per pixel with rows padded to whole bytes
+#ifndef HLC_TILE_POOL_SIZE
+#    define HLC_TILE_POOL_SIZE 14336
+#endif
+
+// Rendered strings kept around, keyed by (string, font, fg, bg)
+#ifndef HLC_TEXT_CACHE_SIZE
+#    define HLC_TEXT_CACHE_SIZE 8
+#endif
+
+// Two colour bitmap, bits set where the foreground colour goes
+typedef struct {
+    uint16_t       width;
+    uint16_t       height;
+    const uint8_t *mask;
+} hlc_tile_t;
+
+bool hlc_tile_capture(hlc_tile_t *tile, const hlc_canvas_t *canvas, uint16_t x, uint16_t y, uint16_t width, uint16_t height, hlc_pixel_t bg);
+void hlc_tile_blit(const hlc_canvas_t *canvas, const hlc_tile_t *tile, uint16_t x, uint16_t y, hlc_pixel_t fg, hlc_pixel_t bg);
+int16_t hlc_text_draw(const hlc_canvas_t *canvas, painter_device_t surface, uint16_t x, uint16_t y, painter_font_handle_t font, const char *text, hlc_color_t fg, hlc_color_t bg);
@@ -1,9 +1,91 @@
 CURRENT_DIR := $(dir $(realpath $(lastword $(MAKEFILE_LIST))))
 
-SRC += $(CURRENT_DIR)/hlc_tft_display.c
+SRC += $(CURRENT_DIR)/hlc_tft_display.c $(CURRENT_DIR)/hlc_tft_dirty.c $(CURRENT_DIR)/hlc_tft_life.c $(CURRENT_DIR)/hlc_tft_raster.c $(CURRENT_DIR)/hlc_tft_tiles.c $(CURRENT_DIR)/hlc_tft_sched.c $(CURRENT_DIR)/hlc_tft_power.c
 CONFIG_H += $(CURRENT_DIR)/config.h
 
-# Fonts
-SRC += $(CURRENT_DIR)/graphics/fonts/Retron2000-27.qff.c $(CURRENT_DIR)/graphics/fonts/Retron2000-underline-27.qff.c
-# Numbers in image format
-SRC += $(CURRENT_DIR)/graphics/numbers/0.qgf.c $(CURRENT_DIR)/graphics/numbers/1.qgf.c $(CURRENT_DIR)/graphics/numbers/2.qgf.c $(CURRENT_DIR)/graphics/numbers/3.qgf.c $(CURRENT_DIR)/graphics/numbers/4.qgf.c $(CURRENT_DIR)/graphics/numbers/5.qgf.c $(CURRENT_DIR)/graphics/numbers/6.qgf.c $(CURRENT_DIR)/graphics/numbers/7.qgf.c $(CURRENT_DIR)/graphics/numbers/8.qgf.c $(CURRENT_DIR)/graphics/numbers/9.qgf.c $(CURRENT_DIR)/graphics/numbers/undef.qgf.c
+# Send the framebuffer with DMA in the background instead of blocking the main loop
+HLC_TFT_ASYNC_FLUSH ?= yes
+
+ifeq ($(strip $(HLC_TFT_ASYNC_FLUSH)), yes)
+    OPT_DEFS += -DHLC_TFT_ASYNC_FLUSH
+    SRC += $(CURRENT_DIR)/hlc_tft_spi.c
+endif
+
+# Draw on the second RP2040 core, the main loop only hands over the keyboard state and sends the finished frames.
+# Core1 draws from flash, it waits in RAM while the EEPROM is written (see hlc_core1.c).
+HLC_TFT_CORE1 ?= no
+
+ifeq ($(strip $(HLC_TFT_CORE1)), yes)
+    OPT_DEFS += -DHLC_TFT_CORE1
+    SRC += $(CURRENT_DIR)/hlc_tft_core1.c
+    HLC_CORE1 = yes
+endif
+
+# Scripted benchmark a few seconds after boot, reports timings and a framebuffer checksum on the console
+HLC_TFT_BENCH ?= no
+
+ifeq ($(strip $(HLC_TFT_BENCH)), yes)
+    OPT_DEFS += -DHLC_TFT_BENCH
+    SRC += $(CURRENT_DIR)/hlc_tft_bench.c
+endif
+
+# Graphics are converted to pre-coloured native RGB565 at build time, set to no to decode the QFF/QGF files at runtime instead
+HLC_TFT_NATIVE_ASSETS ?= yes
+# Native assets are stored run length encoded in a single bundle and decoded while drawing, set to no for plain pixel arrays
+HLC_TFT_ASSET_BUNDLE ?= yes
+
+ifeq ($(strip $(HLC_TFT_NATIVE_ASSETS)), yes)
+    HLC_TFT_DIR := $(CURRENT_DIR)
+    ifeq ($(strip $(HLC_TFT_ASSET_BUNDLE)), yes)
+        HLC_TFT_ASSETS_C := $(INTERMEDIATE_OUTPUT)/hlc_assets/hlc_tft_assets_bundle.c
+        HLC_TFT_ASSETS_FLAGS := --bundle
+        OPT_DEFS += -DHLC_TFT_ASSET_BUNDLE
+    else
+        HLC_TFT_ASSETS_C := $(INTERMEDIATE_OUTPUT)/hlc_assets/hlc_tft_assets_data$(if $(filter yes,$(strip $(HLC_TFT_INDEXED_FB))),_indexed).c
+        HLC_TFT_ASSETS_FLAGS := $(if $(filter yes,$(strip $(HLC_TFT_INDEXED_FB))),--indexed)
+    endif
+    HLC_TFT_NUMBERS := 0 1 2 3 4 5 6 7 8 9
+
+    OPT_DEFS += -DHLC_TFT_NATIVE_ASSETS
+    VPATH += $(HLC_TFT_DIR)
+    SRC += $(HLC_TFT_DIR)/hlc_tft_assets.c $(HLC_TFT_ASSETS_C)
+
+    $(HLC_TFT_ASSETS_C): $(HLC_TFT_DIR)/tools/hlc_assets.py $(HLC_TFT_DIR)/hlc_tft_display.h $(wildcard $(HLC_TFT_DIR)/graphics/fonts/*.qff.c $(HLC_TFT_DIR)/graphics/numbers/*.qgf.c)
+		@mkdir -p $(dir $@)
+		python3 $(HLC_TFT_DIR)/tools/hlc_assets.py --header $(HLC_TFT_DIR)/hlc_tft_display.h --output $@ $(HLC_TFT_ASSETS_FLAGS) \
+			$(foreach n,$(HLC_TFT_NUMBERS),--image number_$(n)=$(HLC_TFT_DIR)/graphics/numbers/$(n).qgf.c:LAYER_$(n)) \
+			--image number_undef=$(HLC_TFT_DIR)/graphics/numbers/undef.qgf.c:LAYER_UNDEF \
+			--group numbers=number_0,number_1,number_2,number_3,number_4,number_5,number_6,number_7,number_8,number_9,number_undef \
+			--text caps_off=$(HLC_TFT_DIR)/graphics/fonts/Retron2000-27.qff.c:CAPS_OFF:Caps \
+			--text caps_on=$(HLC_TFT_DIR)/graphics/fonts/Retron2000-underline-27.qff.c:CAPS_ON:Caps \
+			--text num_off=$(HLC_TFT_DIR)/graphics/fonts/Retron2000-27.qff.c:NUM_OFF:Num \
+			--text num_on=$(HLC_TFT_DIR)/graphics/fonts/Retron2000-underline-27.qff.c:NUM_ON:Num \
+			--text scroll_off=$(HLC_TFT_DIR)/graphics/fonts/Retron2000-27.qff.c:SCROLL_OFF:Scroll \
+			--text scroll_on=$(HLC_TFT_DIR)/graphics/fonts/Retron2000-underline-27.qff.c:SCROLL_ON:Scroll
+else
+    # Fonts
+    SRC += $(CURRENT_DIR)/graphics/fonts/Retron2000-27.qff.c $(CURRENT_DIR)/graphics/fonts/Retron2000-underline-27.qff.c
+    # Numbers in image format
+    SRC += $(CURRENT_DIR)/graphics/numbers/0.qgf.c $(CURRENT_DIR)/graphics/numbers/1.qgf.c $(CURRENT_DIR)/graphics/numbers/2.qgf.c $(CURRENT_DIR)/graphics/numbers/3.qgf.c $(CURRENT_DIR)/graphics/numbers/4.qgf.c $(CURRENT_DIR)/graphics/numbers/5.qgf.c $(CURRENT_DIR)/graphics/numbers/6.qgf.c $(CURRENT_DIR)/graphics/numbers/7.qgf.c $(CURRENT_DIR)/graphics/numbers/8.qgf.c $(CURRENT_DIR)/graphics/numbers/9.qgf.c $(CURRENT_DIR)/graphics/numbers/undef.qgf.c
+endif
+
+# Framebuffer of palette indexes (one byte per pixel) instead of RGB565, saves 32 KB of RAM
+HLC_TFT_INDEXED_FB ?= no
+
+ifeq ($(strip $(HLC_TFT_INDEXED_FB)), yes)
+    ifneq ($(strip $(HLC_TFT_NATIVE_ASSETS)), yes)
+        $(error HLC_TFT_INDEXED_FB requires HLC_TFT_NATIVE_ASSETS = yes)
+    endif
+    OPT_DEFS += -DHLC_TFT_INDEXED_FB
+endif
+
+# No framebuffer at all, the screen is rendered from a display list in 16 row strips while it is sent
+HLC_TFT_STRIP_RENDER ?= no
+
+ifeq ($(strip $(HLC_TFT_STRIP_RENDER)), yes)
+    ifneq ($(strip $(HLC_TFT_NATIVE_ASSETS))$(strip $(HLC_TFT_ASYNC_FLUSH))$(strip $(HLC_TFT_INDEXED_FB)), yesyesno)
+        $(error HLC_TFT_STRIP_RENDER requires HLC_TFT_NATIVE_ASSETS = yes and HLC_TFT_ASYNC_FLUSH = yes, and HLC_TFT_INDEXED_FB = no)
+    endif
+    OPT_DEFS += -DHLC_TFT_STRIP_RENDER
+    SRC += $(CURRENT_DIR)/hlc_tft_strip.c
+endif
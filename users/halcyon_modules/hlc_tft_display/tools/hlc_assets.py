@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+# Copyright 2024 splitkb.com (support@splitkb.com)
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Converts the Quantum Painter QGF/QFF assets of the TFT module into pre-coloured framebuffer arrays.
+
+Images are given as NAME=file.qgf.c:COLOR and strings as NAME=file.qff.c:COLOR:Text, where COLOR is the
+suffix of one of the HSV_* defines in hlc_tft_display.h. The background is always HSV_BLACK.
+Pixels are native RGB565, or hlc_color_t palette indexes with --indexed.
+
+With --bundle all images go into a single run length encoded blob instead. Every asset is a stream of
+alternating background/foreground runs, a run byte of 255 means the run continues in the next byte.
+Identical streams and palettes (foreground/background hlc_color_t pairs) are only stored once.
+"""
+import argparse
+import re
+from pathlib import Path
+
+
+def load_c_array(path):
+    """Reads the byte array out of a `qmk painter-convert-*` generated source file."""
+    source = Path(path).read_text()
+    body = source[source.index('{', source.index('const uint8_t')) + 1:source.rindex('}')]
+    return bytes(int(value, 16) for value in re.findall(r'0x[0-9A-Fa-f]{2}', body))
+
+
+def read_blocks(data):
+    """Splits a QGF/QFF file in its blocks: type id, inverted type id, 24 bit length, payload."""
+    blocks = {}
+    offset = 0
+    while offset < len(data):
+        type_id = data[offset]
+        length = int.from_bytes(data[offset + 2:offset + 5], 'little')
+        blocks.setdefault(type_id, data[offset + 5:offset + 5 + length])
+        offset += 5 + length
+    return blocks
+
+
+def decode_rle(data, length):
+    """QP RLE: a marker below 128 repeats the next byte that many times, otherwise (marker - 127) literal bytes follow."""
+    out = bytearray()
+    offset = 0
+    while len(out) < length:
+        marker = data[offset]
+        offset += 1
+        if marker >= 128:
+            count = marker - 127
+            out += data[offset:offset + count]
+            offset += count
+        else:
+            out += bytes([data[offset]]) * marker
+            offset += 1
+    return bytes(out[:length])
+
+
+def unpack_1bpp(data, compressed, width, height):
+    """Returns rows of booleans, pixels are packed LSB first without row padding."""
+    size = (width * height + 7) // 8
+    data = decode_rle(data, size) if compressed else data[:size]
+    bits = [(data[i >> 3] >> (i & 7)) & 1 for i in range(width * height)]
+    return [bits[y * width:(y + 1) * width] for y in range(height)]
+
+
+def load_image(path):
+    blocks = read_blocks(load_c_array(path))
+    descriptor, frame = blocks[0x00], blocks[0x02]
+    width = int.from_bytes(descriptor[12:14], 'little')
+    height = int.from_bytes(descriptor[14:16], 'little')
+    if frame[0] != 0x00:
+        raise ValueError(f'{path}: only mono2 (1bpp grayscale) images are supported')
+    return unpack_1bpp(blocks[0x05], frame[2] == 0x01, width, height)
+
+
+def load_text(path, text):
+    blocks = read_blocks(load_c_array(path))
+    descriptor, ascii_table, glyph_data = blocks[0x00], blocks[0x01], blocks[0x04]
+    line_height = descriptor[12]
+    if descriptor[16] != 0x00:
+        raise ValueError(f'{path}: only mono2 (1bpp grayscale) fonts are supported')
+    compressed = descriptor[18] == 0x01
+
+    rows = [[] for _ in range(line_height)]
+    for char in text:
+        entry = int.from_bytes(ascii_table[(ord(char) - 0x20) * 3:(ord(char) - 0x20) * 3 + 3], 'little')
+        width, offset = entry & 0x3F, entry >> 6
+        glyph = unpack_1bpp(glyph_data[offset:], compressed, width, line_height)
+        for y in range(line_height):
+            rows[y] += glyph[y]
+    return rows
+
+
+def load_palette(header):
+    """Collects the HSV_* defines of hlc_tft_display.h."""
+    palette = {'BLACK': (0, 0, 0)}
+    for name, values in re.findall(r'^#define HSV_(\w+)\s+(\d+\s*,\s*\d+\s*,\s*\d+)', Path(header).read_text(), re.MULTILINE):
+        palette[name] = tuple(int(v) for v in values.split(','))
+    return palette
+
+
+def hsv_to_rgb565_swapped(hue, sat, val):
+    """Same integer maths as hsv_to_rgb_nocie() and the QP RGB565 palette conversion."""
+    if sat == 0:
+        red = green = blue = val
+    else:
+        region = hue * 6 // 255
+        remainder = ((hue * 2 - region * 85) * 3) & 0xFF
+        p = (val * (255 - sat)) >> 8
+        q = (val * (255 - ((sat * remainder) >> 8))) >> 8
+        t = (val * (255 - ((sat * (255 - remainder)) >> 8))) >> 8
+        red, green, blue = {
+            0: (val, t, p),
+            1: (q, val, p),
+            2: (p, val, t),
+            3: (p, q, val),
+            4: (t, p, val),
+            6: (val, t, p),
+        }.get(region, (val, p, q))
+    rgb565 = (red >> 3) << 11 | (green >> 2) << 5 | (blue >> 3)
+    return ((rgb565 & 0xFF) << 8) | (rgb565 >> 8)
+
+
+def emit_asset(name, rows, fg, bg):
+    """fg and bg are C expressions, they are only spelled out once per asset."""
+    height, width = len(rows), len(rows[0])
+    pixels = ['FG' if bit else 'BG' for row in rows for bit in row]
+    lines = [f'#define FG {fg}', f'#define BG {bg}', f'static const hlc_pixel_t {name}_pixels[{width * height}] = {{']
+    for start in range(0, len(pixels), 24):
+        lines.append('    ' + ' '.join(f'{pixel},' for pixel in pixels[start:start + 24]))
+    lines += ['};', '#undef FG', '#undef BG']
+    return '\n'.join(lines), f'{{{width}, {height}, {name}_pixels}}'
+
+
+def encode_runs(rows):
+    """Run lengths of alternating background and foreground pixels, starting with the background."""
+    out = bytearray()
+    current, run = 0, 0
+    for bit in (bit for row in rows for bit in row):
+        if bit != current:
+            out += b'\xff' * (run // 255) + bytes([run % 255])
+            current, run = bit, 0
+        run += 1
+    out += b'\xff' * (run // 255) + bytes([run % 255])
+    return bytes(out)
+
+
+class Bundle:
+    """Collects the compressed assets, emitted as one byte array with an index of hlc_asset_t descriptors."""
+
+    def __init__(self):
+        self.data = bytearray()
+        self.streams = {}
+        self.palettes = {}
+
+    def add(self, name, rows, fg, bg):
+        stream = encode_runs(rows)
+        if stream not in self.streams:
+            self.streams[stream] = (len(self.data), name)
+            self.data += stream
+        palette = self.palettes.setdefault((fg, bg), len(self.palettes))
+        offset = self.streams[stream][0]
+        return f'{{{len(rows[0])}, {len(rows)}, {palette}, &hlc_asset_bundle[{offset}]}}'
+
+    def emit(self):
+        starts = {offset: name for offset, name in self.streams.values()}
+        lines = [f'const uint8_t hlc_asset_palettes[{len(self.palettes)}][2] = {{']
+        lines += [f'    {{{fg}, {bg}}},' for fg, bg in self.palettes]
+        lines += ['};', '', f'static const uint8_t hlc_asset_bundle[{len(self.data)}] = {{']
+        offset = 0
+        for start in sorted(starts) + [len(self.data)]:
+            for chunk in range(offset, start, 24):
+                lines.append('    ' + ' '.join(f'0x{byte:02X},' for byte in self.data[chunk:min(chunk + 24, start)]))
+            if start < len(self.data):
+                lines.append(f'    // {starts[start]}')
+            offset = start
+        lines.append('};')
+        return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--header', required=True, help='hlc_tft_display.h with the HSV_* colours')
+    parser.add_argument('--output', required=True, help='generated C source')
+    parser.add_argument('--image', action='append', default=[], help='NAME=file.qgf.c:COLOR')
+    parser.add_argument('--text', action='append', default=[], help='NAME=file.qff.c:COLOR:Text')
+    parser.add_argument('--group', action='append', default=[], help='NAME=ASSET,ASSET,... emitted as an array')
+    parser.add_argument('--indexed', action='store_true', help='emit palette indexes for HLC_TFT_INDEXED_FB')
+    parser.add_argument('--bundle', action='store_true', help='emit a compressed bundle for HLC_TFT_ASSET_BUNDLE')
+    args = parser.parse_args()
+
+    palette = load_palette(args.header)
+
+    def colour(name):
+        # Colours that aren't defined (HSV_LAYER_8 for example) fall back to the undefined layer colour
+        if name not in palette:
+            name = 'LAYER_UNDEF'
+        if args.indexed or args.bundle:
+            return f'HLC_COLOR_{name}'
+        return f'0x{hsv_to_rgb565_swapped(*palette[name]):04X}'
+
+    background = colour('BLACK')
+    bundle = Bundle() if args.bundle else None
+
+    def add_asset(name, rows, colour_name):
+        if bundle:
+            return '', bundle.add(name, rows, colour(colour_name), background)
+        return emit_asset(f'hlc_asset_{name}', rows, colour(colour_name), background)
+
+    assets = {}
+    for spec in args.image:
+        name, rest = spec.split('=', 1)
+        path, colour_name = rest.rsplit(':', 1)
+        assets[name] = add_asset(name, load_image(path), colour_name)
+    for spec in args.text:
+        name, rest = spec.split('=', 1)
+        path, colour_name, text = rest.rsplit(':', 2)
+        assets[name] = add_asset(name, load_text(path, text), colour_name)
+
+    grouped = set()
+    out = [
+        '// Copyright 2024 splitkb.com (support@splitkb.com)',
+        '// SPDX-License-Identifier: GPL-2.0-or-later',
+        '',
+        '// This file was generated by hlc_tft_display/tools/hlc_assets.py, do not edit',
+        '',
+        '#include "hlc_tft_assets.h"',
+        '',
+        '// clang-format off',
+    ]
+    if bundle:
+        out += [bundle.emit(), '']
+    for name, (pixels, _) in assets.items():
+        if pixels:
+            out += [pixels, '']
+    for spec in args.group:
+        name, members = spec.split('=', 1)
+        members = members.split(',')
+        grouped.update(members)
+        out.append(f'const hlc_asset_t hlc_asset_{name}[{len(members)}] = {{')
+        out += [f'    {assets[member][1]},' for member in members]
+        out += ['};', '']
+    for name, (_, initializer) in assets.items():
+        if name not in grouped:
+            out.append(f'const hlc_asset_t hlc_asset_{name} = {initializer};')
+    out.append('// clang-format on')
+
+    output = Path(args.output)
+    output.parent.mkdir(parents=True, exist_ok=True)
+    output.write_text('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -18,6 +18,42 @@ QUANTUM_PAINTER_DRIVERS += st7789_spi surface
 BACKLIGHT_ENABLE = yes
 BACKLIGHT_DRIVER = pwm
 
+# Latency histograms of the housekeeping zones and the matrix scan, dumped on the console with HLC_PROFILE_DUMP
+HLC_PROFILE_ENABLE ?= no
+
+ifeq ($(strip $(HLC_PROFILE_ENABLE)), yes)
+  OPT_DEFS += -DHLC_PROFILE_ENABLE
+  SRC += hlc_profile.c
+endif
+
+# 1€ filter on the combined pointing reports, smooths the jitter of slow trackpad movement
+HLC_POINTING_SMOOTH ?= no
+
+ifeq ($(strip $(HLC_POINTING_SMOOTH)), yes)
+  OPT_DEFS += -DHLC_POINTING_SMOOTH
+  HLC_POINTING = yes
+endif
+
+# Q16.16 pointer acceleration of the combined pointing reports, see hlc_pointing.c for the curve
+HLC_POINTING_ACCEL ?= no
+
+ifeq ($(strip $(HLC_POINTING_ACCEL)), yes)
+  OPT_DEFS += -DHLC_POINTING_ACCEL
+  HLC_POINTING = yes
+endif
+
+# Slave pointing motion is accumulated and fetched once per USB poll interval instead of using SPLIT_POINTING_ENABLE
+HLC_POINTING_SYNC ?= no
+
+ifeq ($(strip $(HLC_POINTING_SYNC)), yes)
+  OPT_DEFS += -DHLC_POINTING_SYNC
+  SRC += hlc_pointing_sync.c
+endif
+
+ifeq ($(strip $(HLC_POINTING)), yes)
+  SRC += hlc_pointing.c
+endif
+
 ifdef HLC_ENCODER
   include $(CURRENT_DIR)/hlc_encoder/rules.mk
 endif
@@ -30,6 +66,33 @@ ifdef HLC_CIRQUE_TRACKPAD
   include $(CURRENT_DIR)/hlc_cirque_trackpad/rules.mk
 endif
 
+# Bit-parallel per key debounce, used when the keymap (or a module) sets DEBOUNCE_TYPE = custom
+ifeq ($(strip $(DEBOUNCE_TYPE)), custom)
+  SRC += hlc_debounce.c
+endif
+
+# Second RP2040 core, started by the modules that offload work to it
+ifeq ($(strip $(HLC_TFT_CORE1))$(strip $(HLC_MATRIX_CORE1_SCAN)), yesyes)
+  $(error HLC_TFT_CORE1 and HLC_MATRIX_CORE1_SCAN both need core1, enable only one of them)
+endif
+
+# Core1 code in flash is parked while the wear leveling driver erases or writes it, this covers every EEPROM write
+ifeq ($(strip $(HLC_CORE1)), yes)
+  ifneq ($(filter-out rp2040_flash, $(strip $(WEAR_LEVELING_DRIVER))),)
+    $(error The second RP2040 core is only parked around the rp2040_flash wear leveling driver, not $(WEAR_LEVELING_DRIVER))
+  endif
+  SRC += hlc_core1.c
+  EXTRALDFLAGS += -Wl,--wrap=backing_store_erase -Wl,--wrap=backing_store_write -Wl,--wrap=backing_store_write_bulk
+
+  # The linked firmware is checked before it is copied out: RAM code must not call into the flash, libgcc included,
+  # and LTO must not have resolved or inlined a backing_store_* call past its wrapper
+  HLC_CORE1_DIR := $(CURRENT_DIR)
+  cpfirmware: hlc-core1-check
+  .PHONY: hlc-core1-check
+  hlc-core1-check: $(BUILD_DIR)/$(TARGET).elf
+		OBJDUMP=$(OBJDUMP) sh $(HLC_CORE1_DIR)/tests/ram_calls.sh $(BUILD_DIR)/$(TARGET).elf
+endif
+
 HLC_OPTIONS := $(HLC_NONE) $(HLC_CIRQUE_TRACKPAD) $(HLC_ENCODER) $(HLC_TFT_DISPLAY)
 
 ifeq ($(filter 1, $(HLC_OPTIONS)), )
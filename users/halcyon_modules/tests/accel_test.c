@@ -0,0 +1,177 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Runs the pointer acceleration of hlc_pointing.c (HLC_POINTING_ACCEL) against the float curve it samples.
+//
+// The gain is measured over REPORTS reports at a constant speed: the sub-count remainders are carried over, so what
+// comes out adds up to the input times the gain to within a count.
+// - curve:     speeds from 1/8 to 15.5 counts/ms, the gain has to rise monotonically and stay within CURVE_TOLERANCE
+//              of the curve, at the offset too. Past the end of the table it holds the gain of the last entry.
+//              Reports stay below 32 counts, at a gain of up to 4 they would be clamped to the 8 bit report.
+// - remainder: curves with a constant gain below and above 1, single count reports have to add up to the gain.
+// - direction: a remainder left over from one direction isn't carried into the other.
+// - disabled:  reports pass unchanged.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hlc_pointing.h"
+
+#define REPORTS 1000
+#define CURVE_TOLERANCE 0.02 // Relative, the table is interpolated linearly
+
+uint32_t test_timer_ms;
+
+static hlc_accel_state_t state;
+static int               out_x, out_y; // What came out since the last configure() or start()
+static int               failures;
+
+// Starts over, the first report only starts the interval measurement
+static void start(uint16_t dt) {
+    state         = (hlc_accel_state_t){0};
+    test_timer_ms += dt;
+    hlc_accel_apply(&state, (report_mouse_t){0});
+    out_x = out_y = 0;
+}
+
+static void configure(hlc_accel_config_t config) {
+    hlc_accel_configure(&config);
+    start(8);
+}
+
+// Speed the module measures for count counts every dt ms
+static double speed(int count, uint16_t dt) {
+    return count * (double)(65536 / dt) / 65536;
+}
+
+static double curve_gain(const hlc_accel_config_t *config, double v) {
+    return config->limit - (config->limit - 1) / pow(1 + exp(config->takeoff * (v - config->offset)), config->growth_rate / config->takeoff);
+}
+
+// Feeds reports of (x, y) every dt ms
+static void feed(int x, int y, uint16_t dt, int reports) {
+    for (int i = 0; i < reports; i++) {
+        test_timer_ms += dt;
+        report_mouse_t report = hlc_accel_apply(&state, (report_mouse_t){.x = x, .y = y});
+        out_x += report.x;
+        out_y += report.y;
+    }
+}
+
+// Average gain of count counts every dt ms
+static double measure_gain(int count, uint16_t dt) {
+    start(dt);
+    feed(count, 0, dt, REPORTS);
+    return (double)out_x / REPORTS / count;
+}
+
+static void check_curve(void) {
+    hlc_accel_config_t config = {.enabled = true, .growth_rate = HLC_ACCEL_GROWTH_RATE, .offset = HLC_ACCEL_OFFSET, .limit = HLC_ACCEL_LIMIT, .takeoff = HLC_ACCEL_TAKEOFF};
+    double             last   = 0;
+
+    // Steps of 1/8 counts/ms up to 2, 1/4 up to 8 and 1/2 up to 15.5
+    static const struct {
+        uint16_t dt;
+        int      first, last;
+    } sweep[] = {{8, 1, 16}, {4, 9, 32}, {2, 17, 31}};
+
+    configure(config);
+    printf("%-10s %12s %10s %10s\n", "curve", "counts/ms", "gain", "expected");
+    for (int i = 0; i < 3; i++) {
+        for (int count = sweep[i].first; count <= sweep[i].last; count++) {
+            double v        = speed(count, sweep[i].dt);
+            double gain     = measure_gain(count, sweep[i].dt);
+            double expected = curve_gain(&config, v);
+            double step     = 2.0 / (REPORTS * count); // What the rounding of the total can take away
+
+            if (count == sweep[i].last) {
+                printf("%-10s %12.3f %10.4f %10.4f\n", "", v, gain, expected);
+            }
+            if (gain < last - step) {
+                fprintf(stderr, "curve: gain falls from %.4f to %.4f at %.3f counts/ms\n", last, gain, v);
+                failures++;
+            }
+            if (fabs(gain - expected) > CURVE_TOLERANCE * expected) {
+                fprintf(stderr, "curve: gain %.4f at %.3f counts/ms, expected %.4f\n", gain, v, expected);
+                failures++;
+            }
+            last = fmax(last, gain);
+        }
+    }
+
+    // 11 counts every 5 ms is about the offset of 2.2 counts/ms where the curve bends, 24 counts/ms is past the table
+    static const struct {
+        const char *name;
+        int         count;
+        uint16_t    dt;
+        double      v; // Where the curve is sampled
+    } points[] = {
+        {"offset", 11, 5, 0},
+        {"limit", 24, 1, (double)((uint32_t)HLC_ACCEL_LUT_SIZE << HLC_ACCEL_LUT_SHIFT) / 65536},
+    };
+    for (int i = 0; i < 2; i++) {
+        double gain     = measure_gain(points[i].count, points[i].dt);
+        double expected = curve_gain(&config, points[i].v ? points[i].v : speed(points[i].count, points[i].dt));
+        printf("%-10s %12.3f %10.4f %10.4f\n", points[i].name, speed(points[i].count, points[i].dt), gain, expected);
+        if (fabs(gain - expected) > CURVE_TOLERANCE * expected) {
+            fprintf(stderr, "curve: gain %.4f at the %s, expected %.4f\n", gain, points[i].name, expected);
+            failures++;
+        }
+    }
+}
+
+// A curve that is at its limit for any speed, the gain is the limit
+static hlc_accel_config_t constant_gain(float gain) {
+    return (hlc_accel_config_t){.enabled = true, .growth_rate = 1.0f, .offset = -20.0f, .limit = gain, .takeoff = 1.0f};
+}
+
+static void check_remainder(void) {
+    static const float gains[] = {0.3f, 0.5f, 1.37f, 2.7f};
+
+    for (int i = 0; i < 4; i++) {
+        double expected = gains[i] * REPORTS;
+
+        configure(constant_gain(gains[i]));
+        feed(1, -1, 8, REPORTS);
+        printf("%-10s gain %.2f: %d single counts came out as %d,%d (%.1f)\n", "remainder", gains[i], REPORTS, out_x, out_y, expected);
+        if (fabs(out_x - expected) > 1 || fabs(-out_y - expected) > 1) {
+            fprintf(stderr, "remainder: %d,%d counts at gain %.2f, expected %.1f\n", out_x, out_y, gains[i], expected);
+            failures++;
+        }
+    }
+}
+
+static void check_direction(void) {
+    configure(constant_gain(0.5f));
+
+    // Half a count to the right is left over, two to the left have to make a whole count
+    feed(1, 0, 8, 1);
+    out_x = 0;
+    feed(-1, 0, 8, 2);
+    printf("%-10s one count right then two left at gain 0.50 came out as %d\n", "direction", out_x);
+    if (out_x != -1) {
+        fprintf(stderr, "direction: the remainder of the other direction was carried over\n");
+        failures++;
+    }
+}
+
+static void check_disabled(void) {
+    hlc_accel_config_t config = constant_gain(3.0f);
+
+    config.enabled = false;
+    configure(config);
+    feed(7, -5, 8, REPORTS);
+    printf("%-10s %d reports of 7,-5 came out as %d,%d\n", "disabled", REPORTS, out_x, out_y);
+    if (out_x != 7 * REPORTS || out_y != -5 * REPORTS) {
+        fprintf(stderr, "disabled: reports were changed\n");
+        failures++;
+    }
+}
+
+int main(void) {
+    check_curve();
+    check_remainder();
+    check_direction();
+    check_disabled();
+    return failures != 0;
+}
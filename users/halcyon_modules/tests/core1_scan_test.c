@@ -0,0 +1,269 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Runs the core1 scan loop of hlc_encoder.c (HLC_MATRIX_CORE1_SCAN) against bouncing keys on the left half of
+// encoder_board.h, with the hardware timer as a simulated clock: every read of it lets a µs pass, applies the SIO
+// writes and moves the keys. Once per ms core0 picks up the events like QMK's matrix scan would.
+//
+// Every key (and the encoder button, the only one on the last row) is pressed and released over and over, both edges
+// bounce for up to BOUNCE_US. Each press has to reach core0 once, within the bounce, a scan and a core0 poll of the
+// first contact, and its release once, DEBOUNCE ms after the last bounce (give or take the ms clock of the debounce,
+// a scan and a poll).
+//
+// The loop is started where core1 would start it and left with longjmp() when the time is up.
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "matrix.h"
+#include "split_util.h"
+#include "debounce.h"
+#include "hlc_encoder/hlc_encoder.h"
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+#define KEYS ((ROWS_PER_HAND - 1) * MATRIX_COLS + 1)
+#define SIM_US 20000000
+#define BOUNCE_US 2000
+#define POLL_US 1000
+#define MAX_CYCLES 256
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+#define PRESS_MAX_US (BOUNCE_US + HLC_SCAN_INTERVAL_US + POLL_US + 100)
+#define RELEASE_MIN_US ((DEBOUNCE - 1) * 1000)
+#define RELEASE_MAX_US ((DEBOUNCE + 1) * 1000 + HLC_SCAN_INTERVAL_US + POLL_US + 100)
+
+sio_mock_t    sio_mock;
+volatile bool isLeftHand   = true;
+bool          debug_matrix = false;
+uint32_t      test_timer_ms;
+
+const matrix_row_t matrix_mask[MATRIX_ROWS] = {
+    0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F,
+};
+
+void matrix_init_kb(void);
+void matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row);
+
+static const pin_t row_pins[ROWS_PER_HAND] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS]   = MATRIX_COL_PINS;
+
+// One press of a key: first contact and last edge of the release
+typedef struct {
+    uint32_t press;
+    uint32_t released;
+} cycle_t;
+
+typedef struct {
+    cycle_t  cycles[MAX_CYCLES];
+    uint16_t count;
+    uint16_t next;     // Next cycle core0 has to see
+    uint32_t edges[MAX_CYCLES * 16];
+    uint16_t edge;     // Next edge of the contact
+    bool     contact;
+    bool     reported; // Pressed as far as core0 knows
+} key_sim_t;
+
+static key_sim_t keys[KEYS];
+static uint32_t  pin_oe;
+static uint32_t  pin_out;
+static timer_mock_t timer;
+static uint32_t  next_edge;
+static uint32_t  next_poll = POLL_US;
+static bool      in_core0;
+static jmp_buf   sim_end;
+static void (*core1_entry)(void);
+
+static uint32_t errors;
+static uint32_t presses, releases;
+static uint64_t press_total, release_total;
+static uint32_t press_max, release_max;
+
+// Bounces: an odd number of edges after the first one, all within BOUNCE_US, ending in the new state
+static uint16_t add_bounces(key_sim_t *key, uint16_t edge, uint32_t start, uint32_t *last) {
+    uint8_t  bounces = (rand() % 3) * 2;
+    uint32_t time    = start;
+
+    key->edges[edge++] = start;
+    for (uint8_t i = 0; i < bounces; i++) {
+        time += 1 + rand() % (BOUNCE_US / (bounces + 1));
+        key->edges[edge++] = time;
+    }
+    *last = time;
+    return edge;
+}
+
+static void generate_keys(void) {
+    for (uint8_t k = 0; k < KEYS; k++) {
+        key_sim_t *key  = &keys[k];
+        uint32_t   time = 0;
+        uint16_t   edge = 0;
+
+        while (key->count < MAX_CYCLES) {
+            cycle_t *cycle = &key->cycles[key->count];
+
+            time += 20000 + rand() % 150000; // Idle
+            if (time >= SIM_US) {
+                break;
+            }
+            cycle->press = time;
+            edge         = add_bounces(key, edge, time, &time);
+            time += 20000 + rand() % 100000; // Held
+            edge = add_bounces(key, edge, time, &cycle->released);
+            time = cycle->released;
+            key->count++;
+        }
+        key->edges[edge] = UINT32_MAX;
+    }
+}
+
+static uint32_t pin_bit(pin_t pin) {
+    return pin == NO_PIN ? 0 : 1UL << pin;
+}
+
+// COL2ROW, a column reads low while a row with a closed key on it is driven low. The last row is the button.
+static void sio_apply(void) {
+    pin_out |= sio_mock.GPIO_OUT_SET;
+    pin_out &= ~sio_mock.GPIO_OUT_CLR;
+    pin_oe |= sio_mock.GPIO_OE_SET;
+    pin_oe &= ~sio_mock.GPIO_OE_CLR;
+    sio_mock.GPIO_OUT_SET = sio_mock.GPIO_OUT_CLR = sio_mock.GPIO_OE_SET = sio_mock.GPIO_OE_CLR = 0;
+
+    uint32_t in = ~pin_oe | pin_out;
+    for (uint8_t row = 0; row < ROWS_PER_HAND - 1; row++) {
+        uint32_t bit = pin_bit(row_pins[row]);
+        if (!(pin_oe & bit) || (pin_out & bit)) {
+            continue;
+        }
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (keys[row * MATRIX_COLS + col].contact) {
+                in &= ~pin_bit(col_pins[col]);
+            }
+        }
+    }
+    if (keys[(ROWS_PER_HAND - 1) * MATRIX_COLS].contact) {
+        in &= ~pin_bit(HLC_ENCODER_BUTTON);
+    }
+    sio_mock.GPIO_IN = in;
+}
+
+static void move_keys(uint32_t now) {
+    next_edge = UINT32_MAX;
+    for (uint8_t k = 0; k < KEYS; k++) {
+        key_sim_t *key = &keys[k];
+        while (key->edges[key->edge] <= now) {
+            key->contact = !key->contact;
+            key->edge++;
+        }
+        if (key->edges[key->edge] < next_edge) {
+            next_edge = key->edges[key->edge];
+        }
+    }
+}
+
+// What QMK's matrix scan sees, checked against the key cycles
+static void core0_poll(uint32_t now) {
+    matrix_row_t matrix[ROWS_PER_HAND];
+
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_read_cols_on_row(matrix, row);
+    }
+
+    for (uint8_t k = 0; k < KEYS; k++) {
+        key_sim_t *key     = &keys[k];
+        bool       pressed = matrix[k / MATRIX_COLS] & (1 << (k % MATRIX_COLS));
+        cycle_t   *cycle   = &key->cycles[key->next];
+
+        if (pressed == key->reported) {
+            continue;
+        }
+        key->reported = pressed;
+
+        if (key->next >= key->count) {
+            errors++;
+            continue;
+        }
+        if (pressed) {
+            uint32_t latency = now - cycle->press;
+            if (now < cycle->press || latency > PRESS_MAX_US) {
+                if (errors++ < 10) {
+                    printf("  key %u: pressed at %u us, contact at %u us\n", k, now, cycle->press);
+                }
+            }
+            presses++;
+            press_total += latency;
+            press_max = latency > press_max ? latency : press_max;
+        } else {
+            uint32_t latency = now - cycle->released;
+            if (now < cycle->released + RELEASE_MIN_US || latency > RELEASE_MAX_US) {
+                if (errors++ < 10) {
+                    printf("  key %u: released at %u us, last bounce at %u us\n", k, now, cycle->released);
+                }
+            }
+            releases++;
+            release_total += latency;
+            release_max = latency > release_max ? latency : release_max;
+            key->next++;
+        }
+    }
+}
+
+timer_mock_t *mock_timer(void) {
+    if (in_core0) {
+        return &timer;
+    }
+
+    uint32_t now = ++timer.TIMERAWL;
+    if (now >= next_edge) {
+        move_keys(now);
+    }
+    sio_apply();
+
+    if (now >= next_poll) {
+        next_poll += POLL_US;
+        in_core0 = true;
+        core0_poll(now);
+        in_core0 = false;
+    }
+    if (now >= SIM_US) {
+        longjmp(sim_end, 1);
+    }
+    return &timer;
+}
+
+void hlc_core1_launch(void (*entry)(void), bool in_ram) {
+    core1_entry = entry;
+}
+
+void gpio_set_pin_input_high(pin_t pin) {
+    pin_oe &= ~pin_bit(pin);
+}
+
+int main(void) {
+    srand(1);
+    generate_keys();
+    move_keys(0);
+    debounce_init(ROWS_PER_HAND);
+    matrix_init_kb();
+
+    if (!setjmp(sim_end)) {
+        core1_entry();
+    }
+
+    // Cycles that ended in time have to be complete
+    uint32_t cycles = 0, missed = 0;
+    for (uint8_t k = 0; k < KEYS; k++) {
+        for (uint16_t c = 0; c < keys[k].count; c++) {
+            if (keys[k].cycles[c].released + RELEASE_MAX_US < SIM_US) {
+                cycles++;
+                missed += c >= keys[k].next;
+            }
+        }
+    }
+
+    const hlc_scan_stats_t *stats = hlc_scan_get_stats();
+    printf("core1 scan: %u scans in %u s, %u overruns, %u key presses with up to %u us bounce, %u missed, %u wrong\n", stats->scans, SIM_US / 1000000, stats->overruns, cycles, BOUNCE_US, missed, errors);
+    printf("            press %.0f us avg %u us max, release %.0f us avg %u us max after the last bounce\n", presses ? (double)press_total / presses : 0, press_max, releases ? (double)release_total / releases : 0, release_max);
+    return missed != 0 || errors != 0 || stats->overruns != 0;
+}
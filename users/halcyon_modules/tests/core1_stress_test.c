@@ -0,0 +1,203 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Runs core1 of the TFT renderer (hlc_tft_core1.c) as a thread against core0 on the main thread, built with
+// -fsanitize=thread so every access the ring and the framebuffer handoff don't order shows up as a race.
+//
+// - The ring alone carries RING_MESSAGES counters from one thread to the other, they have to arrive in order.
+// - The renderer stands in for the real one: it takes the inputs, fills the framebuffer with the frame number and
+//   runs "from flash" while it does. Core0 checks it gets back whole frames in order and scribbles over them while it
+//   owns them, like the SPI flush reading the tiles and the Life grid being stepped.
+// - Core0 writes the "flash" through the backing store wrappers of hlc_core1.c, bulk writes going through the single
+//   ones like QMK's default does. Core1 may never be in flash while a write runs.
+//
+// The launch handshake with the boot ROM is left out, core1 is started as a thread and launched is set by hand.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../hlc_core1.c"
+#include "../hlc_tft_display/hlc_tft_core1.c"
+
+#define RING_MESSAGES 1000000
+#define FRAMES 100000
+#define FRAMEBUFFER_SIZE 256
+#define WRITE_EVERY 97 // Frames between flash writes
+
+SIO_TypeDef hal_sio;
+SCB_Type    hal_scb;
+systime_t   test_system_time;
+
+static atomic_bool in_flash;
+static atomic_uint flash_violations;
+static uint32_t    flash_calls;
+
+// Core0 only ever touches these while it owns the frame, core1 while it doesn't
+static uint32_t framebuffer[FRAMEBUFFER_SIZE];
+static uint32_t rendered_frames;
+static uint32_t inputs_seen[HLC_CORE1_INPUTS];
+static uint32_t input_errors;
+
+// Flash writes
+
+static void flash_busy(void) {
+    flash_calls++;
+    for (int i = 0; i < 20; i++) {
+        if (atomic_load(&in_flash)) {
+            atomic_fetch_add(&flash_violations, 1);
+        }
+        sched_yield();
+    }
+}
+
+bool __real_backing_store_erase(void) {
+    flash_busy();
+    return true;
+}
+
+bool __real_backing_store_write(uint32_t address, backing_store_int_t value) {
+    flash_busy();
+    return true;
+}
+
+bool __real_backing_store_write_bulk(uint32_t address, backing_store_int_t *values, size_t item_count) {
+    for (size_t i = 0; i < item_count; i++) {
+        __wrap_backing_store_write(address + i * sizeof(backing_store_int_t), values[i]);
+    }
+    return true;
+}
+
+// Core1
+
+static void test_input(const hlc_msg_t *msg) {
+    // Values only go up, and an input is only queued when it changed
+    if (msg->type >= HLC_CORE1_INPUTS || msg->value <= inputs_seen[msg->type]) {
+        input_errors++;
+        return;
+    }
+    inputs_seen[msg->type] = msg->value;
+}
+
+static void test_render(void) {
+    atomic_store(&in_flash, true);
+    rendered_frames++;
+    for (int i = 0; i < FRAMEBUFFER_SIZE; i++) {
+        framebuffer[i] = rendered_frames;
+        if (i % 64 == 0) {
+            sched_yield();
+        }
+    }
+    atomic_store(&in_flash, false);
+}
+
+static void *core1_thread(void *arg) {
+    core1_main();
+    return NULL;
+}
+
+// Ring alone
+
+static hlc_ring_t test_ring;
+
+static void *ring_consumer(void *arg) {
+    uint32_t *errors = arg;
+    uint32_t  next   = 0;
+    hlc_msg_t msg;
+
+    while (next < RING_MESSAGES) {
+        if (!hlc_ring_pop(&test_ring, &msg)) {
+            sched_yield();
+            continue;
+        }
+        if (msg.value != next || msg.type != (uint8_t)next) {
+            (*errors)++;
+        }
+        next = msg.value + 1;
+    }
+    return NULL;
+}
+
+static bool test_ring_order(void) {
+    pthread_t thread;
+    uint32_t  errors = 0;
+    uint32_t  full   = 0;
+
+    pthread_create(&thread, NULL, ring_consumer, &errors);
+    for (uint32_t i = 0; i < RING_MESSAGES;) {
+        hlc_msg_t msg = {.type = (uint8_t)i, .value = i};
+        if (hlc_ring_push(&test_ring, &msg)) {
+            i++;
+        } else {
+            full++;
+            sched_yield();
+        }
+    }
+    pthread_join(thread, NULL);
+
+    printf("ring: %u messages, ring full %u times, %u out of order\n", RING_MESSAGES, full, errors);
+    return errors == 0;
+}
+
+// Framebuffer handoff
+
+static bool test_handoff(void) {
+    pthread_t          thread;
+    uint32_t           frames      = 0;
+    uint32_t           frame_errors = 0;
+    uint32_t           values[HLC_CORE1_INPUTS] = {0};
+    backing_store_int_t bulk[8]    = {0};
+
+    launched = true; // Skips the handshake in hlc_core1_launch()
+    hlc_core1_start(test_input, test_render);
+    pthread_create(&thread, NULL, core1_thread, NULL);
+    pthread_detach(thread); // Core1 never returns
+
+    while (frames < FRAMES) {
+        // Inputs change more often than frames are drawn, some have to wait for a free slot
+        for (int i = 0; i < 3; i++) {
+            hlc_core1_input_t type = (hlc_core1_input_t)((frames + i) % HLC_CORE1_INPUTS);
+            hlc_core1_set_input(type, ++values[type]);
+        }
+
+        if (!hlc_core1_frame_ready()) {
+            sched_yield();
+            continue;
+        }
+        if (frames > 0) {
+            for (int i = 0; i < FRAMEBUFFER_SIZE; i++) {
+                if (framebuffer[i] != frames) {
+                    frame_errors++;
+                    break;
+                }
+            }
+        }
+        for (int i = 0; i < FRAMEBUFFER_SIZE; i++) {
+            framebuffer[i] = ~frames;
+        }
+        hlc_core1_release_frame();
+        frames++;
+
+        // Core1 is drawing the next frame
+        if (frames % WRITE_EVERY == 0) {
+            if (frames % (WRITE_EVERY * 4) == 0) {
+                __wrap_backing_store_erase();
+            }
+            __wrap_backing_store_write(0, (backing_store_int_t)frames);
+            __wrap_backing_store_write_bulk(0, bulk, ARRAY_SIZE(bulk));
+        }
+    }
+    while (!hlc_core1_frame_ready()) {
+        sched_yield();
+    }
+
+    const hlc_core1_stats_t *stats = hlc_core1_get_stats();
+    printf("handoff: %u frames, %u inputs posted, ring full %u times, %u flash calls in %u parks\n", stats->frames, stats->posted, stats->ring_full, flash_calls, hlc_core1_parks());
+    printf("         %u bad frames, %u bad inputs, %u flash calls while core1 was in flash\n", frame_errors, input_errors, atomic_load(&flash_violations));
+    return frame_errors == 0 && input_errors == 0 && atomic_load(&flash_violations) == 0 && flash_writes == 0;
+}
+
+int main(void) {
+    bool ok = test_ring_order();
+    ok      = test_handoff() && ok;
+    return !ok;
+}
@@ -0,0 +1,331 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Replays bouncing key traces through hlc_debounce.c and through ports of the QMK debounce it stands in for,
+// asym_eager_defer_pk by default and sym_defer_pk with HLC_DEBOUNCE_SYM_DEFER. Both get the same raw matrix every
+// scan, the debounced matrices have to be the same after every scan.
+//
+// Every key of the matrix is pressed for 30-200 ms and released for 30-300 ms, each edge bounces for up to the
+// given time. The traces are replayed at several scan rates, including scans further apart than DEBOUNCE.
+// Also reports the press/release latency and the transitions that didn't match the key (chatter) for both.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debounce.h"
+#include "hlc_debounce.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#define TRACE_MS 120000
+
+uint32_t test_timer_ms;
+
+// Ports of quantum/debounce/asym_eager_defer_pk.c and sym_defer_pk.c, with the state in a struct so they can run
+// next to hlc_debounce.c
+
+#define DEBOUNCE_ELAPSED 0
+
+typedef struct {
+    uint8_t      time[MATRIX_ROWS][MATRIX_COLS];
+    bool         pressed[MATRIX_ROWS][MATRIX_COLS];
+    bool         counters_need_update;
+    bool         matrix_need_update;
+    bool         cooked_changed;
+    fast_timer_t last_time;
+} reference_t;
+
+static reference_t reference;
+
+static void reference_init(void) {
+    memset(&reference, 0, sizeof(reference));
+    reference.last_time = timer_read_fast();
+}
+
+#ifdef HLC_DEBOUNCE_SYM_DEFER
+#    define REFERENCE_NAME "sym_defer_pk"
+
+static void reference_update(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
+    reference.counters_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t *time = &reference.time[row][col];
+            if (*time != DEBOUNCE_ELAPSED) {
+                if (*time <= elapsed_time) {
+                    *time                = DEBOUNCE_ELAPSED;
+                    matrix_row_t col_mask = MATRIX_ROW_SHIFTER << col;
+                    matrix_row_t cooked_next = (cooked[row] & ~col_mask) | (raw[row] & col_mask);
+                    reference.cooked_changed |= cooked[row] ^ cooked_next;
+                    cooked[row] = cooked_next;
+                } else {
+                    *time -= elapsed_time;
+                    reference.counters_need_update = true;
+                }
+            }
+        }
+    }
+}
+
+static void reference_transfer(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta = raw[row] ^ cooked[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t *time = &reference.time[row][col];
+            if (delta & (MATRIX_ROW_SHIFTER << col)) {
+                if (*time == DEBOUNCE_ELAPSED) {
+                    *time                          = DEBOUNCE;
+                    reference.counters_need_update = true;
+                }
+            } else {
+                *time = DEBOUNCE_ELAPSED;
+            }
+        }
+    }
+}
+
+static bool reference_debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool updated_last = false;
+
+    reference.cooked_changed = false;
+    if (reference.counters_need_update) {
+        fast_timer_t now          = timer_read_fast();
+        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, reference.last_time);
+
+        reference.last_time = now;
+        updated_last        = true;
+        if (elapsed_time > UINT8_MAX) {
+            elapsed_time = UINT8_MAX;
+        }
+        if (elapsed_time > 0) {
+            reference_update(raw, cooked, num_rows, elapsed_time);
+        }
+    }
+    if (changed) {
+        if (!updated_last) {
+            reference.last_time = timer_read_fast();
+        }
+        reference_transfer(raw, cooked, num_rows);
+    }
+    return reference.cooked_changed;
+}
+#else
+#    define REFERENCE_NAME "asym_eager_defer_pk"
+
+static void reference_update(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
+    reference.counters_need_update = false;
+    reference.matrix_need_update   = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t col_mask = MATRIX_ROW_SHIFTER << col;
+            uint8_t     *time     = &reference.time[row][col];
+            if (*time != DEBOUNCE_ELAPSED) {
+                if (*time <= elapsed_time) {
+                    *time = DEBOUNCE_ELAPSED;
+                    if (reference.pressed[row][col]) {
+                        // key-down: eager
+                        reference.matrix_need_update = true;
+                    } else {
+                        // key-up: defer
+                        matrix_row_t cooked_next = (cooked[row] & ~col_mask) | (raw[row] & col_mask);
+                        reference.cooked_changed |= cooked_next ^ cooked[row];
+                        cooked[row] = cooked_next;
+                    }
+                } else {
+                    *time -= elapsed_time;
+                    reference.counters_need_update = true;
+                }
+            }
+        }
+    }
+}
+
+static void reference_transfer(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    reference.matrix_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta = raw[row] ^ cooked[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t col_mask = MATRIX_ROW_SHIFTER << col;
+            uint8_t     *time     = &reference.time[row][col];
+            if (delta & col_mask) {
+                if (*time == DEBOUNCE_ELAPSED) {
+                    reference.pressed[row][col]    = (raw[row] & col_mask);
+                    *time                          = DEBOUNCE;
+                    reference.counters_need_update = true;
+                    if (reference.pressed[row][col]) {
+                        // key-down: eager
+                        cooked[row] ^= col_mask;
+                        reference.cooked_changed = true;
+                    }
+                }
+            } else if (*time != DEBOUNCE_ELAPSED) {
+                if (!reference.pressed[row][col]) {
+                    // key-up: defer
+                    *time = DEBOUNCE_ELAPSED;
+                }
+            }
+        }
+    }
+}
+
+static bool reference_debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool updated_last = false;
+
+    reference.cooked_changed = false;
+    if (reference.counters_need_update) {
+        fast_timer_t now          = timer_read_fast();
+        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, reference.last_time);
+
+        reference.last_time = now;
+        updated_last        = true;
+        if (elapsed_time > UINT8_MAX) {
+            elapsed_time = UINT8_MAX;
+        }
+        if (elapsed_time > 0) {
+            reference_update(raw, cooked, num_rows, elapsed_time);
+        }
+    }
+    if (changed || reference.matrix_need_update) {
+        if (!updated_last) {
+            reference.last_time = timer_read_fast();
+        }
+        reference_transfer(raw, cooked, num_rows);
+    }
+    return reference.cooked_changed;
+}
+#endif
+
+// The trace, generated from a fixed seed so every run sees the same bounces
+
+static uint32_t random_state;
+
+static uint32_t random_next(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+typedef struct {
+    bool     pressed;      // What the finger does
+    uint32_t next_edge;    // ms
+    uint32_t bounce_until; // ms, the contact reads random until then
+} trace_key_t;
+
+typedef struct {
+    const char  *name;
+    uint32_t     transitions;
+    uint32_t     chatter; // Reported transitions to a state the key isn't in
+    uint64_t     latency_us[2];
+    uint32_t     latency_count[2];
+    uint32_t     edge_us[MATRIX_ROWS][MATRIX_COLS]; // Last edge of the key that wasn't reported yet
+    bool         edge_pending[MATRIX_ROWS][MATRIX_COLS];
+    matrix_row_t cooked[MATRIX_ROWS];
+    matrix_row_t previous[MATRIX_ROWS];
+} result_t;
+
+static trace_key_t keys[MATRIX_ROWS][MATRIX_COLS];
+
+static void track(result_t *result, uint32_t now_us) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix_row_t flipped = result->cooked[row] ^ result->previous[row];
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (!(flipped & (MATRIX_ROW_SHIFTER << col))) {
+                continue;
+            }
+            bool pressed = result->cooked[row] & (MATRIX_ROW_SHIFTER << col);
+            result->transitions++;
+            if (pressed != keys[row][col].pressed) {
+                result->chatter++;
+            } else if (result->edge_pending[row][col]) {
+                result->latency_us[pressed] += now_us - result->edge_us[row][col];
+                result->latency_count[pressed]++;
+                result->edge_pending[row][col] = false;
+            }
+        }
+        result->previous[row] = result->cooked[row];
+    }
+}
+
+static void print_result(const result_t *result) {
+    printf("    %-20s %6u transitions %4u chatter   press %5.2f ms   release %5.2f ms\n", result->name, result->transitions, result->chatter, result->latency_count[1] ? result->latency_us[1] / 1000.0 / result->latency_count[1] : 0, result->latency_count[0] ? result->latency_us[0] / 1000.0 / result->latency_count[0] : 0);
+}
+
+// Replays one trace, scanning every scan_us. Returns the number of scans after which the matrices differed.
+static uint32_t replay(uint32_t scan_us, uint32_t bounce_ms) {
+    static result_t hlc, ref;
+    matrix_row_t    raw[MATRIX_ROWS] = {0};
+    uint32_t        mismatched_scans = 0;
+    uint32_t        edges            = 0;
+
+    memset(&hlc, 0, sizeof(hlc));
+    memset(&ref, 0, sizeof(ref));
+    memset(keys, 0, sizeof(keys));
+    hlc.name = "hlc_debounce";
+    ref.name = REFERENCE_NAME;
+    random_state  = 0x9E3779B9u ^ scan_us ^ (bounce_ms << 20);
+    test_timer_ms = 0;
+    debounce_init(MATRIX_ROWS);
+    reference_init();
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            keys[row][col].next_edge = random_next() % 300;
+        }
+    }
+
+    for (uint32_t now_us = 0; now_us < TRACE_MS * 1000; now_us += scan_us) {
+        uint32_t     now_ms = now_us / 1000;
+        matrix_row_t before[MATRIX_ROWS];
+
+        test_timer_ms = now_ms;
+        memcpy(before, raw, sizeof(raw));
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                trace_key_t *key = &keys[row][col];
+                if (now_ms >= key->next_edge) {
+                    key->pressed      = !key->pressed;
+                    key->bounce_until = now_ms + random_next() % (bounce_ms + 1);
+                    key->next_edge    = now_ms + (key->pressed ? 30 + random_next() % 170 : 30 + random_next() % 270);
+                    hlc.edge_us[row][col] = ref.edge_us[row][col] = now_us;
+                    hlc.edge_pending[row][col] = ref.edge_pending[row][col] = true;
+                    edges++;
+                }
+                bool level = key->pressed;
+                if (now_ms < key->bounce_until) {
+                    level = random_next() & 1;
+                }
+                raw[row] = level ? raw[row] | (MATRIX_ROW_SHIFTER << col) : raw[row] & ~(MATRIX_ROW_SHIFTER << col);
+            }
+        }
+
+        bool changed = memcmp(before, raw, sizeof(raw)) != 0;
+        debounce(raw, hlc.cooked, MATRIX_ROWS, changed);
+        reference_debounce(raw, ref.cooked, MATRIX_ROWS, changed);
+        if (memcmp(hlc.cooked, ref.cooked, sizeof(hlc.cooked)) != 0) {
+            mismatched_scans++;
+        }
+
+        track(&hlc, now_us);
+        track(&ref, now_us);
+    }
+
+    printf("  scan every %5u us, bounce up to %u ms: %u key edges, %u scans differ\n", scan_us, bounce_ms, edges, mismatched_scans);
+    print_result(&hlc);
+    print_result(&ref);
+    return mismatched_scans;
+}
+
+int main(void) {
+    static const uint32_t scan_us[]   = {250, 1000, 3000, 7000};
+    static const uint32_t bounce_ms[] = {1, 3, DEBOUNCE};
+    uint32_t              failed      = 0;
+
+    printf("DEBOUNCE %u ms, hlc_debounce against %s\n", DEBOUNCE, REFERENCE_NAME);
+    for (uint8_t s = 0; s < sizeof(scan_us) / sizeof(scan_us[0]); s++) {
+        for (uint8_t b = 0; b < sizeof(bounce_ms) / sizeof(bounce_ms[0]); b++) {
+            failed += replay(scan_us[s], bounce_ms[b]);
+        }
+    }
+    return failed != 0;
+}
@@ -0,0 +1,58 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Board config for port_scan_test.c, included ahead of hlc_encoder.c like QMK's generated config would be.
+// ENCODER_LAYOUT picks the pins: 0 has other pins on the right half and columns out of order, 1 consecutive
+// columns, 2 a column without a pin.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gpio.h"
+
+#define MCU_RP
+#define SPLIT_KEYBOARD
+#define MATRIX_MASKED
+#define MATRIX_ROWS 10
+#define MATRIX_COLS 7
+
+#define COL2ROW 0
+#define ROW2COL 1
+#define DIODE_DIRECTION COL2ROW
+
+#define HLC_ENCODER_BUTTON 16
+
+#if ENCODER_LAYOUT == 0
+#    define MATRIX_ROW_PINS {4, 5, 6, 7, 8}
+#    define MATRIX_COL_PINS {28, 18, 19, 20, 21, 22, 23}
+#    define MATRIX_ROW_PINS_RIGHT {9, 10, 11, 12, 14}
+#    define MATRIX_COL_PINS_RIGHT {23, 22, 21, 20, 19, 18, 28}
+#elif ENCODER_LAYOUT == 1
+#    define MATRIX_ROW_PINS {4, 5, 6, 7, 8}
+#    define MATRIX_COL_PINS {18, 19, 20, 21, 22, 23, 24}
+#elif ENCODER_LAYOUT == 2
+#    define MATRIX_ROW_PINS {4, 5, 6, 7, 8}
+#    define MATRIX_COL_PINS {18, NO_PIN, 20, 21, 22, 23, 24}
+#endif
+
+// The SIO block of the RP2040, only the registers the port scan uses
+typedef struct {
+    volatile uint32_t GPIO_IN;
+    volatile uint32_t GPIO_OUT_SET;
+    volatile uint32_t GPIO_OUT_CLR;
+    volatile uint32_t GPIO_OE_SET;
+    volatile uint32_t GPIO_OE_CLR;
+} sio_mock_t;
+
+extern sio_mock_t sio_mock;
+
+#define SIO (&sio_mock)
+
+// The RP2040 timer for the core1 scan, time passes on every read (see core1_scan_test.c)
+typedef struct {
+    uint32_t TIMERAWL;
+} timer_mock_t;
+
+timer_mock_t *mock_timer(void);
+
+#define TIMER (mock_timer())
@@ -0,0 +1,10 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// hlc_encoder.c with the pin by pin scan, renamed so it links next to the port scan build in port_scan_test
+#undef HLC_MATRIX_PORT_SCAN
+#define matrix_init_kb pin_scan_matrix_init_kb
+#define matrix_read_cols_on_row pin_scan_matrix_read_cols_on_row
+#define hlc_matrix_scan_rate pin_scan_matrix_scan_rate
+
+#include "hlc_encoder/hlc_encoder.c"
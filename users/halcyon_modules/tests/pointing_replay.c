@@ -0,0 +1,199 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Replays absolute trackpad traces (see traces/gen_pointing.py) through the 1€ filter of hlc_pointing.c and reports
+// what it does to the jitter and how far the pointer falls behind.
+//
+// - Jitter is the RMS of the second difference of the position, 0 for any path at a constant speed.
+// - Latency is the delay at which the filtered position reaches 10%, 20% .. 90% of the travel after the raw one did,
+//   crossing times are interpolated between reports.
+// - End error is where the filtered pointer stopped relative to the raw one, what the resets at rest dropped.
+//
+// Fails when the filter doesn't lower the jitter of a trace that stays below SLOW_SPEED, or raises the jitter of any
+// trace: a fast flick is meant to pass unfiltered and its second difference is mostly its own acceleration. Also fails
+// when the latency goes above MAX_LATENCY_MEAN or MAX_LATENCY, or when the pointer ends up more than MAX_END_ERROR
+// counts away from where it should be.
+//
+// The traces are synthetic, there is no recording of a Cirque in absolute mode to replay yet. Their noise is gaussian
+// and the latency of the slow trace depends on it: the raw position crosses a level early or late by about the noise
+// over the speed.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hlc_pointing.h"
+
+#define MAX_SAMPLES 20000
+#define SLOW_SPEED 2.0 // counts/ms
+#define MAX_END_ERROR 3
+#define MAX_LATENCY_MEAN 40.0 // ms
+#define MAX_LATENCY 80.0      // ms
+
+uint32_t test_timer_ms;
+
+typedef struct {
+    uint32_t time[MAX_SAMPLES];
+    double   raw_x[MAX_SAMPLES];
+    double   raw_y[MAX_SAMPLES];
+    double   out_x[MAX_SAMPLES];
+    double   out_y[MAX_SAMPLES];
+    int      count;
+} trace_t;
+
+static trace_t trace;
+
+static bool load_trace(const char *path) {
+    FILE    *file = fopen(path, "r");
+    uint32_t time;
+    double   x, y;
+
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    trace.count = 0;
+    while (trace.count < MAX_SAMPLES && fscanf(file, "%u %lf %lf", &time, &x, &y) == 3) {
+        trace.time[trace.count]  = time;
+        trace.raw_x[trace.count] = round(x); // The sensor reports whole counts
+        trace.raw_y[trace.count] = round(y);
+        trace.count++;
+    }
+    fclose(file);
+    return trace.count > 2;
+}
+
+// Feeds the position changes to the filter like QMK would, and integrates what comes out
+static void replay(void) {
+    hlc_smooth_state_t state = {0};
+    double             x     = trace.raw_x[0];
+    double             y     = trace.raw_y[0];
+
+    // A first empty report starts the interval measurement
+    test_timer_ms = trace.time[0] - 10;
+    hlc_smooth_apply(&state, (report_mouse_t){0});
+
+    for (int i = 0; i < trace.count; i++) {
+        report_mouse_t report = {0};
+        if (i > 0) {
+            report.x = (mouse_xy_report_t)(trace.raw_x[i] - trace.raw_x[i - 1]);
+            report.y = (mouse_xy_report_t)(trace.raw_y[i] - trace.raw_y[i - 1]);
+        }
+
+        test_timer_ms = trace.time[i];
+        report        = hlc_smooth_apply(&state, report);
+        x += report.x;
+        y += report.y;
+        trace.out_x[i] = x;
+        trace.out_y[i] = y;
+    }
+}
+
+static double jitter(const double *x, const double *y) {
+    double sum = 0;
+
+    for (int i = 2; i < trace.count; i++) {
+        double dx = x[i] - 2 * x[i - 1] + x[i - 2];
+        double dy = y[i] - 2 * y[i - 1] + y[i - 2];
+        sum += dx * dx + dy * dy;
+    }
+    return sqrt(sum / (trace.count - 2));
+}
+
+// Interpolated time at which position first reaches level, moving in the direction of sign
+static double crossing_time(const double *position, double level, double sign) {
+    for (int i = 1; i < trace.count; i++) {
+        if ((position[i] - level) * sign >= 0) {
+            double step = position[i] - position[i - 1];
+            double frac = step != 0 ? (level - position[i - 1]) / step : 1;
+            return trace.time[i - 1] + frac * (trace.time[i] - trace.time[i - 1]);
+        }
+    }
+    return NAN;
+}
+
+// Fastest the raw position moved between two reports, in counts/ms
+static double peak_speed(void) {
+    double peak = 0;
+
+    for (int i = 1; i < trace.count; i++) {
+        double distance = hypot(trace.raw_x[i] - trace.raw_x[i - 1], trace.raw_y[i] - trace.raw_y[i - 1]);
+        peak            = fmax(peak, distance / (trace.time[i] - trace.time[i - 1]));
+    }
+    return peak;
+}
+
+// Mean and max latency along the axis with the most travel, false for a trace that hardly moves
+static bool latency(double *mean, double *max) {
+    int           last = trace.count - 1;
+    bool          on_x = fabs(trace.raw_x[last] - trace.raw_x[0]) > fabs(trace.raw_y[last] - trace.raw_y[0]);
+    const double *raw  = on_x ? trace.raw_x : trace.raw_y;
+    const double *out  = on_x ? trace.out_x : trace.out_y;
+    double        span = raw[last] - raw[0];
+    int           count = 0;
+
+    *mean = 0;
+    *max  = 0;
+    if (fabs(span) < 20) {
+        return false;
+    }
+    for (int step = 1; step < 10; step++) {
+        double level = raw[0] + span * step / 10;
+        double delay = crossing_time(out, level, span > 0 ? 1 : -1) - crossing_time(raw, level, span > 0 ? 1 : -1);
+        if (isnan(delay)) {
+            continue;
+        }
+        *mean += delay;
+        *max = fmax(*max, delay);
+        count++;
+    }
+    if (count == 0) {
+        return false;
+    }
+    *mean /= count;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int failed = 0;
+
+    printf("%-28s %10s %10s %14s %14s %12s\n", "trace", "jitter raw", "filtered", "latency mean", "latency max", "end error");
+    for (int arg = 1; arg < argc; arg++) {
+        if (!load_trace(argv[arg])) {
+            fprintf(stderr, "%s: no trace\n", argv[arg]);
+            return 1;
+        }
+        replay();
+
+        int    last         = trace.count - 1;
+        double raw_jitter   = jitter(trace.raw_x, trace.raw_y);
+        double out_jitter   = jitter(trace.out_x, trace.out_y);
+        double latency_mean = 0, latency_max = 0;
+        char   latency_text[2][16] = {"-", "-"};
+
+        if (latency(&latency_mean, &latency_max)) {
+            snprintf(latency_text[0], sizeof(latency_text[0]), "%.1f ms", latency_mean);
+            snprintf(latency_text[1], sizeof(latency_text[1]), "%.1f ms", latency_max);
+        }
+        double end_x = trace.out_x[last] - trace.raw_x[last];
+        double end_y = trace.out_y[last] - trace.raw_y[last];
+        printf("%-28s %10.3f %10.3f %14s %14s %5.0f,%-6.0f\n", argv[arg], raw_jitter, out_jitter, latency_text[0], latency_text[1], end_x, end_y);
+
+        if (peak_speed() < SLOW_SPEED && out_jitter >= raw_jitter) {
+            fprintf(stderr, "%s: the filter didn't lower the jitter\n", argv[arg]);
+            failed = 1;
+        }
+        if (out_jitter > raw_jitter) {
+            fprintf(stderr, "%s: the filter raised the jitter\n", argv[arg]);
+            failed = 1;
+        }
+        if (latency_mean > MAX_LATENCY_MEAN || latency_max > MAX_LATENCY) {
+            fprintf(stderr, "%s: the pointer falls %.1f ms behind, %.1f ms at most\n", argv[arg], latency_mean, latency_max);
+            failed = 1;
+        }
+        if (fabs(end_x) > MAX_END_ERROR || fabs(end_y) > MAX_END_ERROR) {
+            fprintf(stderr, "%s: the pointer ended up %.0f,%.0f counts off\n", argv[arg], end_x, end_y);
+            failed = 1;
+        }
+    }
+    return failed;
+}
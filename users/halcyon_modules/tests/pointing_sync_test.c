@@ -0,0 +1,253 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Plays both halves of hlc_pointing_sync.c: the slave's pointing device reports the motion of a trace (see
+// traces/gen_pointing.py, deltas every 10 ms, each one up to JITTER_MS late) or nothing at all while idle, the master
+// runs its task and a pointing report every ms and the RPC goes straight to the slave's handler.
+//
+// The link load is counted like QMK's split transport sends it: every transaction is its id and the target's echo of
+// it plus the buffers, and an RPC is four transactions (PUT_RPC_INFO with 4 bytes, PUT_RPC_REQ, EXECUTE_RPC with 1 byte
+// and GET_RPC_RESP). Stock SPLIT_POINTING_ENABLE is counted next to it: every POINTING_DEVICE_TASK_THROTTLE_MS (1)
+// the master reads a 1 byte checksum of the slave's last report and the report itself when it differs, or after
+// FORCED_SYNC_THROTTLE_MS.
+//
+// Every trace is also replayed with a fifth of the requests and a fifth of the replies lost. Fails when any motion
+// or click goes missing, or when the link load of any run ends up above stock.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hlc_pointing_sync.h"
+#include "split_util.h"
+#include "transactions.h"
+
+#define MAX_SAMPLES 20000
+#define IDLE_MS 10000
+#define FLUSH_MS 100
+#define TRANSACTION_BYTES 2 // Transaction id and its echo
+#define RPC_BYTES (4 * TRANSACTION_BYTES + 4 + 1)
+#define FORCED_SYNC_THROTTLE_MS 100
+#define JITTER_MS 2
+
+uint32_t test_timer_ms;
+
+static bool             master;
+static slave_callback_t slave_handler;
+static bool             lossy;
+static uint32_t         link_bytes;
+
+bool is_keyboard_master(void) {
+    return master;
+}
+
+bool is_keyboard_left(void) {
+    return master;
+}
+
+bool is_transport_connected(void) {
+    return true;
+}
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback) {
+    slave_handler = callback;
+}
+
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    uint8_t reply[32];
+
+    link_bytes += RPC_BYTES + initiator2target_buffer_size + target2initiator_buffer_size;
+    if (lossy && rand() % 5 == 0) {
+        return false; // Lost before the slave got it
+    }
+    master = false;
+    slave_handler(initiator2target_buffer_size, initiator2target_buffer, target2initiator_buffer_size, reply);
+    master = true;
+    if (lossy && rand() % 5 == 0) {
+        return false; // The slave made a packet, the master never got it
+    }
+    memcpy(target2initiator_buffer, reply, target2initiator_buffer_size);
+    return true;
+}
+
+report_mouse_t pointing_device_task_combined_kb(report_mouse_t left_report, report_mouse_t right_report) {
+    return pointing_device_task_combined_user(left_report, right_report);
+}
+
+// The slave's reports, one per ms
+static report_mouse_t slave_reports[MAX_SAMPLES * 10 + IDLE_MS];
+static uint32_t       duration;
+
+static bool load_trace(const char *path) {
+    FILE    *file = fopen(path, "r");
+    uint32_t time;
+    double   x, y, last_x = 0, last_y = 0;
+    bool     first = true;
+
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    memset(slave_reports, 0, sizeof(slave_reports));
+    duration = 0;
+    while (fscanf(file, "%u %lf %lf", &time, &x, &y) == 3 && time < MAX_SAMPLES * 10) {
+        x = round(x);
+        y = round(y);
+        time += rand() % (JITTER_MS + 1);
+        if (!first) {
+            slave_reports[time].x = (mouse_xy_report_t)(x - last_x);
+            slave_reports[time].y = (mouse_xy_report_t)(y - last_y);
+        }
+        first    = false;
+        last_x   = x;
+        last_y   = y;
+        duration = time + 1;
+    }
+    fclose(file);
+    return duration > 0;
+}
+
+// A tap on the slave's first button every 700 ms, a single report long
+static void add_taps(void) {
+    for (uint32_t time = 350; time < duration; time += 700) {
+        slave_reports[time].buttons = 1;
+    }
+}
+
+typedef struct {
+    double   bytes_per_s;
+    double   stock_bytes_per_s;
+    double   fetches_per_s;
+    double   early_per_s;
+    double   delay_ms;        // Average time motion spends between the halves, the backlog over the throughput
+    int32_t  lost_x, lost_y;
+    int32_t  lost_clicks;
+    uint32_t first_motion_ms; // From the first slave report with motion to the first master report with motion
+} result_t;
+
+static uint8_t checksum(const report_mouse_t *report) {
+    const uint8_t *bytes = (const uint8_t *)report;
+    uint8_t        sum   = 0x5A;
+
+    for (size_t i = 0; i < sizeof(*report); i++) {
+        sum = (uint8_t)((sum << 1 | sum >> 7) ^ bytes[i]);
+    }
+    return sum;
+}
+
+// Stock SPLIT_POINTING_ENABLE, the slave's shared report is its last one
+static uint32_t stock_bytes(void) {
+    report_mouse_t master_copy = {0};
+    uint32_t       last_update = 0;
+    uint32_t       bytes       = 0;
+
+    for (uint32_t time = 0; time < duration + FLUSH_MS; time++) {
+        report_mouse_t shared = time < duration ? slave_reports[time] : (report_mouse_t){0};
+
+        bytes += TRANSACTION_BYTES + 1;
+        if (checksum(&shared) != checksum(&master_copy) || time - last_update >= FORCED_SYNC_THROTTLE_MS) {
+            bytes += TRANSACTION_BYTES + sizeof(report_mouse_t);
+            master_copy = shared;
+            last_update = time;
+        }
+    }
+    return bytes;
+}
+
+static result_t replay(void) {
+    result_t result      = {0};
+    int32_t  in_x        = 0, in_y = 0, out_x = 0, out_y = 0;
+    int32_t  clicks      = 0, out_clicks = 0;
+    int32_t  first_in    = -1, first_out = -1;
+    uint8_t  out_buttons = 0;
+    double   backlog     = 0, distance = 0;
+
+    hlc_pointing_sync_stats_t before = *hlc_pointing_sync_get_stats();
+    link_bytes                       = 0;
+    for (test_timer_ms = 1; test_timer_ms < duration + FLUSH_MS; test_timer_ms++) {
+        if (test_timer_ms < duration) {
+            report_mouse_t report = slave_reports[test_timer_ms];
+
+            if ((report.x || report.y) && first_in < 0) {
+                first_in = test_timer_ms;
+            }
+            in_x += report.x;
+            in_y += report.y;
+            distance += abs(report.x) + abs(report.y);
+            clicks += report.buttons != 0;
+            master = false;
+            pointing_device_task_kb(report);
+        }
+
+        master = true;
+        hlc_pointing_sync_task();
+        report_mouse_t report = pointing_device_task_kb((report_mouse_t){0});
+        if ((report.x || report.y) && first_out < 0) {
+            first_out = test_timer_ms;
+        }
+        out_x += report.x;
+        out_y += report.y;
+        out_clicks += report.buttons && !out_buttons;
+        out_buttons = report.buttons;
+        backlog += abs(in_x - out_x) + abs(in_y - out_y);
+    }
+
+    const hlc_pointing_sync_stats_t *after = hlc_pointing_sync_get_stats();
+
+    uint32_t ms              = duration + FLUSH_MS;
+    result.bytes_per_s       = link_bytes * 1000.0 / ms;
+    result.stock_bytes_per_s = stock_bytes() * 1000.0 / ms;
+    result.fetches_per_s     = (after->polls - before.polls) * 1000.0 / ms;
+    result.early_per_s       = (after->early - before.early) * 1000.0 / ms;
+    result.delay_ms          = distance > 0 ? backlog / distance : 0;
+    result.lost_x            = in_x - out_x;
+    result.lost_y            = in_y - out_y;
+    result.lost_clicks       = clicks - out_clicks;
+    result.first_motion_ms   = first_in >= 0 && first_out >= 0 ? (uint32_t)(first_out - first_in) : 0;
+    return result;
+}
+
+static bool check(const char *name) {
+    bool failed = false;
+
+    for (int run = 0; run < 2; run++) {
+        lossy           = run == 1;
+        result_t result = replay();
+
+        printf("%-28s %-6s %9.0f B/s %9.0f B/s %9.0f/s %7.0f/s %8.1f ms %8u ms %6d,%-6d %6d\n", name, lossy ? "lossy" : "clean", result.bytes_per_s, result.stock_bytes_per_s, result.fetches_per_s, result.early_per_s, result.delay_ms, result.first_motion_ms, result.lost_x, result.lost_y, result.lost_clicks);
+        if (result.lost_x || result.lost_y || result.lost_clicks) {
+            fprintf(stderr, "%s: motion or clicks went missing\n", name);
+            failed = true;
+        }
+        if (result.bytes_per_s > result.stock_bytes_per_s) {
+            fprintf(stderr, "%s: %s link load above stock\n", name, lossy ? "lossy" : "clean");
+            failed = true;
+        }
+    }
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    int failed = 0;
+
+    srand(1);
+    hlc_pointing_sync_init();
+    printf("%-28s %-6s %13s %13s %11s %9s %11s %11s %13s %6s\n", "trace", "link", "sync", "stock", "fetches", "early", "delay", "1st motion", "lost x,y", "clicks");
+
+    memset(slave_reports, 0, sizeof(slave_reports));
+    duration = IDLE_MS;
+    failed |= check("idle");
+
+    for (int arg = 1; arg < argc; arg++) {
+        if (!load_trace(argv[arg])) {
+            fprintf(stderr, "%s: no trace\n", argv[arg]);
+            return 1;
+        }
+        add_taps();
+        failed |= check(argv[arg]);
+    }
+
+    const hlc_pointing_sync_stats_t *stats = hlc_pointing_sync_get_stats();
+    printf("%u fetches, %u with motion, %u idle, %u early, %u failed\n", stats->polls, stats->motion, stats->idle, stats->early, stats->failed);
+    return failed;
+}
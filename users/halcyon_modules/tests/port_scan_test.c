@@ -0,0 +1,212 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Scans a mocked matrix with the port scan of hlc_encoder.c (HLC_MATRIX_PORT_SCAN) and with its pin by pin scan
+// (encoder_pin_scan.c) and compares the two, on both halves of the board in encoder_board.h.
+//
+// The mock wires the keys COL2ROW: a column reads low while a row it has a pressed key on is driven low. The pins are
+// shared by both scanners, the SIO set/clear registers are applied whenever a scanner waits or touches a pin (the
+// hardware does it right away, neither scanner reads between a write and its next delay).
+//
+// Every row sees all 128 key patterns with the encoder button up and down, followed by random matrices. The pin scan
+// doesn't mask, QMK applies matrix_mask to it later, so the port scan has to match the pin scan masked with the
+// matrix_mask row of the half, right hand rows are ROWS_PER_HAND further down. The masks of the two halves differ so a
+// wrong offset shows up. After every row no row may be left selected.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix.h"
+#include "split_util.h"
+#include "debug.h"
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+#define PIN_COUNT 30
+#define RANDOM_SCANS 20000
+
+void pin_scan_matrix_init_kb(void);
+void pin_scan_matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row);
+void matrix_init_kb(void);
+void matrix_read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row);
+
+sio_mock_t    sio_mock;
+volatile bool isLeftHand = true;
+bool          debug_matrix = false;
+uint32_t      test_timer_ms;
+
+// Left rows, then right rows, every row of a half is masked differently from the same row of the other half
+const matrix_row_t matrix_mask[MATRIX_ROWS] = {
+    0b1111110, 0b1011111, 0b1111111, 0b0111111, 0b0011111,
+    0b1111101, 0b1111110, 0b0110111, 0b1111011, 0b0000001,
+};
+
+static const pin_t left_rows[ROWS_PER_HAND] = MATRIX_ROW_PINS;
+static const pin_t left_cols[MATRIX_COLS]   = MATRIX_COL_PINS;
+#ifdef MATRIX_ROW_PINS_RIGHT
+static const pin_t right_rows[ROWS_PER_HAND] = MATRIX_ROW_PINS_RIGHT;
+#else
+#    define right_rows left_rows
+#endif
+#ifdef MATRIX_COL_PINS_RIGHT
+static const pin_t right_cols[MATRIX_COLS] = MATRIX_COL_PINS_RIGHT;
+#else
+#    define right_cols left_cols
+#endif
+
+// The electrical state of the half being scanned
+static const pin_t *row_pins;
+static const pin_t *col_pins;
+static matrix_row_t keys[ROWS_PER_HAND]; // The last row is the encoder button, no keys on it
+static bool         button;
+static uint32_t     pin_oe;
+static uint32_t     pin_out;
+
+static inline uint32_t pin_bit(pin_t pin) {
+    return pin == NO_PIN ? 0 : 1UL << pin;
+}
+
+// Rows that are driven low, a scan selects one at a time
+static uint32_t selected_rows(void) {
+    uint32_t selected = 0;
+
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        uint32_t bit = pin_bit(row_pins[row]);
+        if ((pin_oe & bit) && !(pin_out & bit)) {
+            selected |= 1UL << row;
+        }
+    }
+    return selected;
+}
+
+static void sio_apply(void) {
+    pin_out |= sio_mock.GPIO_OUT_SET;
+    pin_out &= ~sio_mock.GPIO_OUT_CLR;
+    pin_oe |= sio_mock.GPIO_OE_SET;
+    pin_oe &= ~sio_mock.GPIO_OE_CLR;
+    sio_mock.GPIO_OUT_SET = sio_mock.GPIO_OUT_CLR = sio_mock.GPIO_OE_SET = sio_mock.GPIO_OE_CLR = 0;
+
+    // Inputs are pulled up, outputs read what they drive
+    uint32_t in       = (~pin_oe | pin_out) & ((1UL << PIN_COUNT) - 1);
+    uint32_t selected = selected_rows();
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        if (!(selected & (1UL << row))) {
+            continue;
+        }
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if ((keys[row] & (MATRIX_ROW_SHIFTER << col)) && !(pin_oe & pin_bit(col_pins[col]))) {
+                in &= ~pin_bit(col_pins[col]);
+            }
+        }
+    }
+    if (button) {
+        in &= ~pin_bit(HLC_ENCODER_BUTTON);
+    }
+    sio_mock.GPIO_IN = in;
+}
+
+void gpio_set_pin_input_high(pin_t pin) {
+    pin_oe &= ~pin_bit(pin);
+    sio_apply();
+}
+
+void gpio_set_pin_output(pin_t pin) {
+    pin_oe |= pin_bit(pin);
+    sio_apply();
+}
+
+void gpio_write_pin_low(pin_t pin) {
+    pin_out &= ~pin_bit(pin);
+    sio_apply();
+}
+
+void gpio_write_pin_high(pin_t pin) {
+    pin_out |= pin_bit(pin);
+    sio_apply();
+}
+
+bool gpio_read_pin(pin_t pin) {
+    sio_apply();
+    return sio_mock.GPIO_IN & pin_bit(pin);
+}
+
+void matrix_output_select_delay(void) {
+    sio_apply();
+}
+
+void matrix_output_unselect_delay(uint8_t line, bool key_pressed) {
+    sio_apply();
+}
+
+static uint32_t scans;
+static uint32_t failures;
+
+// Scans the current keys with both scanners and compares them row by row
+static void compare_scans(void) {
+    uint8_t      mask_offset = isLeftHand ? 0 : ROWS_PER_HAND;
+    matrix_row_t pin_matrix[ROWS_PER_HAND];
+    matrix_row_t port_matrix[ROWS_PER_HAND];
+
+    scans++;
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        pin_scan_matrix_read_cols_on_row(pin_matrix, row);
+        uint32_t pin_left_selected = selected_rows();
+        matrix_read_cols_on_row(port_matrix, row);
+        uint32_t port_left_selected = selected_rows();
+
+        matrix_row_t mask     = matrix_mask[row + mask_offset];
+        matrix_row_t expected = pin_matrix[row] & mask;
+        if (port_matrix[row] != expected || pin_left_selected || port_left_selected) {
+            if (failures++ < 10) {
+                printf("  %s half, row %u, keys %02x, button %u: pin scan %02x, masked %02x, port scan %02x, rows left selected %02x/%02x\n", isLeftHand ? "left" : "right", row, keys[row], button, pin_matrix[row], expected, port_matrix[row], pin_left_selected, port_left_selected);
+            }
+        }
+    }
+}
+
+static void scan_half(bool left) {
+    isLeftHand = left;
+    row_pins   = left ? left_rows : right_rows;
+    col_pins   = left ? left_cols : right_cols;
+    pin_oe     = 0;
+    pin_out    = 0;
+    memset(keys, 0, sizeof(keys));
+    button = false;
+
+    pin_scan_matrix_init_kb();
+    matrix_init_kb();
+    sio_apply();
+
+    // Every pattern on every row, the rows get it rotated so they differ from each other
+    for (uint16_t pattern = 0; pattern < (1 << MATRIX_COLS); pattern++) {
+        for (uint8_t row = 0; row < ROWS_PER_HAND - 1; row++) {
+            keys[row] = (matrix_row_t)((pattern << row) | (pattern >> (MATRIX_COLS - row))) & ((1 << MATRIX_COLS) - 1);
+        }
+        for (uint8_t down = 0; down < 2; down++) {
+            button = down;
+            compare_scans();
+        }
+    }
+
+    srand(left ? 1 : 2);
+    for (uint32_t i = 0; i < RANDOM_SCANS; i++) {
+        for (uint8_t row = 0; row < ROWS_PER_HAND - 1; row++) {
+            keys[row] = rand() & ((1 << MATRIX_COLS) - 1);
+        }
+        button = rand() & 1;
+        compare_scans();
+    }
+}
+
+int main(void) {
+    scan_half(true);
+    scan_half(false);
+
+    printf("layout %u%s: %u scans of both halves, %u rows differ\n", ENCODER_LAYOUT,
+#ifdef MATRIX_UNSELECT_DRIVE_HIGH
+           " (unselect drives high)",
+#else
+           "",
+#endif
+           scans, failures);
+    return failures != 0;
+}
@@ -0,0 +1,117 @@
+#!/bin/sh
+# Copyright 2024 splitkb.com (support@splitkb.com)
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+# Lists the calls and jumps from the code core1 runs from RAM to code outside of it and fails if there are any, besides
+# the mocked hardware (mock_*) of the host tests. Core1 can't leave the RAM while core0 writes the flash.
+#
+# A host build of the tests keeps the RAM code in its .time_critical sections. The host compiler inlines and calls its
+# own helpers, so the firmware is checked as well: on the RP2040 ELF (OBJDUMP, arm-none-eabi-objdump by default) the
+# RAM code is every function the linker script placed in the SRAM, and a call from it into the XIP flash fails, libgcc
+# helpers included. The firmware check also fails when LTO resolved a call to one of the wrapped backing_store_*
+# functions (-Wl,--wrap, see hlc_core1.c) past its wrapper, or inlined it so that nothing calls the wrapper any more.
+# rules.mk runs it after every firmware build with HLC_CORE1.
+
+binary=$1
+
+# Calls of the disassembly on stdin as "caller target address", GNU and LLVM objdump output
+calls() {
+    awk '
+        /^[0-9a-f]+ <.*>:$/ {
+            caller = $0
+            sub(/^[0-9a-f]+ </, "", caller)
+            sub(/>:$/, "", caller)
+            next
+        }
+        match($0, /[ \t](call[a-z]*|jmp[a-z]*|j[a-z][a-z]?[a-z]?|bl|blx|b|b[a-z][a-z])(\.[nw])?[ \t]+(0x)?[0-9a-f]+ <[^>]*>/) {
+            split(substr($0, RSTART + 1, RLENGTH - 1), operand, /[ \t]+/)
+            address = operand[2]
+            sub(/^0x/, "", address)
+            while (length(address) < 8) {
+                address = "0" address
+            }
+            target = operand[3]
+            sub(/^</, "", target)
+            sub(/[+>].*$/, "", target)
+            if (target != caller) {
+                print caller, target, address
+            }
+        }' | sort -u
+}
+
+# e_machine 40 is ARM
+if [ "$(od -An -tu1 -j18 -N1 "$binary" | tr -d ' ')" = 40 ]; then
+    objdump=${OBJDUMP:-arm-none-eabi-objdump}
+
+    # Function symbols as "name section address"
+    functions=$($objdump -t "$binary" | awk '{ for (i = 2; i < NF; i++) if ($i == "F") { print $NF, $(i + 1), $1; break } }')
+    ram=$(echo "$functions" | awk '$3 >= "20000000" && $3 < "20042000" { print $1 }')
+    sections=$(echo "$functions" | awk '$3 >= "20000000" && $3 < "20042000" { print $2 }' | sort -u)
+    if [ -z "$ram" ]; then
+        echo "$binary: no functions in RAM"
+        exit 1
+    fi
+
+    # The SRAM sections aren't code as far as objdump is concerned, they are disassembled on their own
+    all_calls=$({
+        $objdump -d "$binary"
+        for section in $sections; do
+            $objdump -D -j "$section" "$binary"
+        done
+    } | calls)
+
+    status=0
+    flash_calls=$(echo "$all_calls" | awk -v ram="$(echo $ram)" '
+        BEGIN { split(ram, names, " "); for (i in names) in_ram[names[i]] = 1 }
+        in_ram[$1] && $3 >= "10000000" && $3 < "20000000" { print $1 " calls " $2 " in flash" }')
+    if [ -n "$flash_calls" ]; then
+        echo "$flash_calls" | sed "s|^|$binary: RAM code |"
+        status=1
+    fi
+
+    for function in backing_store_erase backing_store_write backing_store_write_bulk; do
+        wrapper=__wrap_$function
+        if ! echo "$functions" | grep -q "^$wrapper "; then
+            continue
+        fi
+        bypass=$(echo "$all_calls" | awk -v wrapped="$function" -v wrapper="$wrapper" '$2 == wrapped && $1 != wrapper { print $1 }')
+        for caller in $bypass; do
+            echo "$binary: $caller calls $function past $wrapper"
+            status=1
+        done
+        if ! echo "$all_calls" | awk -v wrapper="$wrapper" '$2 == wrapper { found = 1 } END { exit !found }'; then
+            echo "$binary: nothing calls $wrapper, LTO inlined $function into its callers"
+            status=1
+        fi
+    done
+    [ $status -eq 0 ] && echo "$binary: RAM code ($(echo $ram)) only calls itself, every backing_store_* call is wrapped"
+    exit $status
+fi
+
+sections=$(objdump -h "$binary" | awk '$2 ~ /^\.time_critical/ { print $2 }')
+
+if [ -z "$sections" ]; then
+    echo "$binary: no .time_critical sections"
+    exit 1
+fi
+
+ram=$(for section in $sections; do objdump -d -j "$section" "$binary"; done | sed -n 's/^[0-9a-f]* <\(.*\)>:$/\1/p')
+targets=$(for section in $sections; do objdump -d -j "$section" "$binary"; done | calls | awk '{ print $2 }' | sort -u)
+
+status=0
+for target in $targets; do
+    case " $(echo $ram) " in
+    *" $target "*) ;;
+    *)
+        case $target in
+        mock_*) ;;
+        *)
+            echo "$binary: RAM code calls $target"
+            status=1
+            ;;
+        esac
+        ;;
+    esac
+done
+[ $status -eq 0 ] && echo "$binary: RAM code ($(echo $ram)) only calls itself"
+exit $status
@@ -0,0 +1,308 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Flushes random framebuffer changes through hlc_tft_spi.c to a mocked ST7789 and checks what ends up on it.
+//
+// The mock behaves like the parts Quantum Painter and the ChibiOS SPI driver play: qp_viewport() needs a free bus
+// (it sends its commands with DC low and releases the bus again), spiStartSend() needs the bus, DC high and no
+// transfer running. The DMA only reads its buffer when the transfer completes, a few flush task calls later, so a
+// chunk that is refilled while it is being sent shows up as wrong pixels. spi_stop() has to come after the last
+// transfer of a window, with the window filled exactly.
+//
+// For a while the bus is taken by another device now and then (spi_start() or qp_viewport() fail). The flush has to
+// end cleanly then and leave the rest of the frame dirty: after every flush, any pixel the display got wrong has to be
+// in a window the next one sends. At the end the display has to match the framebuffer.
+//
+// Built three times: native RGB565 (full width windows in one transfer, narrower ones gathered in chunks),
+// HLC_TFT_INDEXED_FB (expanded in chunks) and HLC_TFT_STRIP_RENDER (full width bands rendered in chunks,
+// hlc_strip_render() is played by the test from its own image).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hlc_tft_spi.h"
+#include "qp_surface_internal.h"
+#include "spi_master.h"
+#include "util.h"
+#ifdef HLC_TFT_STRIP_RENDER
+#    include "hlc_tft_strip.h"
+#endif
+
+#define FRAMES 3000
+#define FAULTY_FRAMES 1000 // Frames in the middle where the bus is busy now and then
+#define BUSY_PERCENT 5     // Chance of a busy bus at every window that is opened
+#define MAX_TASK_CALLS 100000
+
+#define PIXELS (LCD_WIDTH * LCD_HEIGHT)
+#ifdef HLC_TFT_STRIP_RENDER
+#    define MAX_TRANSFER (HLC_SPI_CHUNK_ROWS * LCD_WIDTH * sizeof(uint16_t))
+#elif defined(HLC_TFT_INDEXED_FB)
+#    define MAX_TRANSFER (HLC_SPI_CHUNK_ROWS * LCD_WIDTH * sizeof(uint16_t))
+#else
+#    define MAX_TRANSFER (PIXELS * sizeof(uint16_t))
+#endif
+
+SPIDriver SPID0 = {.state = SPI_READY};
+
+// The strip renderer has no framebuffer, the test's image stands in for its display list
+static hlc_pixel_t              framebuffer[PIXELS] __attribute__((aligned(4)));
+static surface_painter_device_t surface;
+static const int                lcd_device;
+static uint16_t                 display[PIXELS];
+
+static struct {
+    bool            started; // spi_start() holds the bus
+    bool            dc_high; // Data, not commands
+    hlc_rect_t      window;
+    uint32_t        cursor;  // Pixels written into the window
+    const uint16_t *tx;      // Transfer the DMA works on
+    size_t          length;
+    uint16_t        snapshot[PIXELS];
+} bus;
+
+static bool     faulty;
+static uint32_t errors;
+static uint32_t windows, transfers, busy, max_transfer, max_task_calls;
+static uint64_t bytes;
+
+#define ERROR(...)                 \
+    do {                           \
+        if (errors++ < 10) {       \
+            printf("  " __VA_ARGS__); \
+        }                          \
+    } while (0)
+
+static inline uint16_t native_pixel(uint32_t i) {
+#ifdef HLC_TFT_INDEXED_FB
+    return hlc_palette_native[framebuffer[i]];
+#else
+    return framebuffer[i];
+#endif
+}
+
+#ifdef HLC_TFT_STRIP_RENDER
+void hlc_strip_render(uint16_t *buffer, uint16_t top, uint16_t rows) {
+    memcpy(buffer, &framebuffer[top * LCD_WIDTH], rows * LCD_WIDTH * sizeof(uint16_t));
+}
+#endif
+
+static uint32_t window_area(void) {
+    return (uint32_t)(bus.window.r - bus.window.l + 1) * (bus.window.b - bus.window.t + 1);
+}
+
+// The DMA reads the buffer only now, it has to be what it was when the transfer started
+static void complete_transfer(void) {
+    uint32_t count = bus.length / sizeof(uint16_t);
+    uint16_t width = bus.window.r - bus.window.l + 1;
+
+    if (SPI_DRIVER.state != SPI_ACTIVE) {
+        return;
+    }
+    if (memcmp(bus.tx, bus.snapshot, bus.length) != 0) {
+        ERROR("transfer buffer changed while it was being sent\n");
+    }
+    for (uint32_t i = 0; i < count; i++, bus.cursor++) {
+        if (bus.cursor >= window_area()) {
+            ERROR("%u pixels sent to a window of %u\n", bus.cursor + count - i, window_area());
+            break;
+        }
+        display[(bus.window.t + bus.cursor / width) * LCD_WIDTH + bus.window.l + bus.cursor % width] = bus.tx[i];
+    }
+    SPI_DRIVER.state = SPI_READY;
+}
+
+bool qp_viewport(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    if (device != &lcd_device) {
+        ERROR("viewport on another device\n");
+    }
+    if (bus.started || SPI_DRIVER.state == SPI_ACTIVE) {
+        ERROR("viewport while the flush holds the bus\n");
+        return false;
+    }
+    if (faulty && rand() % 100 < BUSY_PERCENT) {
+        busy++;
+        return false;
+    }
+    if (left > right || top > bottom || right >= LCD_WIDTH || bottom >= LCD_HEIGHT) {
+        ERROR("viewport %u,%u-%u,%u\n", left, top, right, bottom);
+        return false;
+    }
+    bus.window  = (hlc_rect_t){left, top, right, bottom};
+    bus.cursor  = 0;
+    bus.dc_high = false; // CASET/RASET/RAMWR
+    windows++;
+    return true;
+}
+
+// Only the blocking flush of hlc_tft_dirty.c sends through Quantum Painter
+bool qp_pixdata(painter_device_t device, const void *pixel_data, uint32_t native_pixel_count) {
+    ERROR("qp_pixdata() called\n");
+    return false;
+}
+
+bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
+    if (bus.started) {
+        ERROR("spi_start() while the bus is held\n");
+        return false;
+    }
+    if (faulty && rand() % 100 < BUSY_PERCENT) {
+        busy++;
+        return false;
+    }
+    bus.started = slavePin == LCD_CS_PIN;
+    return bus.started;
+}
+
+void spi_stop(void) {
+    if (SPI_DRIVER.state == SPI_ACTIVE) {
+        ERROR("spi_stop() during a transfer\n");
+        complete_transfer();
+    }
+    if (bus.cursor != window_area()) {
+        ERROR("window %u,%u-%u,%u closed after %u of %u pixels\n", bus.window.l, bus.window.t, bus.window.r, bus.window.b, bus.cursor, window_area());
+    }
+    bus.started = false;
+}
+
+void spiStartSend(SPIDriver *spip, size_t n, const void *txbuf) {
+    if (!bus.started || !bus.dc_high) {
+        ERROR("transfer without the bus or with DC low\n");
+    }
+    if (spip->state != SPI_READY) {
+        ERROR("transfer started during another one\n");
+        complete_transfer();
+    }
+    if (n == 0 || n % sizeof(uint16_t) || n > MAX_TRANSFER) {
+        ERROR("transfer of %zu bytes\n", n);
+        n = MIN(n & ~1, MAX_TRANSFER);
+    }
+    bus.tx     = txbuf;
+    bus.length = n;
+    memcpy(bus.snapshot, txbuf, n);
+    spip->state = SPI_ACTIVE;
+
+    transfers++;
+    bytes += n;
+    max_transfer = MAX(max_transfer, n);
+}
+
+void gpio_write_pin_high(pin_t pin) {
+    if (pin == LCD_DC_PIN) {
+        bus.dc_high = true;
+    }
+}
+
+// A few rects of one colour each, marked like the display code does or through the surface's dirty box
+static void draw_changes(void) {
+    uint8_t count = 1 + rand() % 4;
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t    w     = rand() % 8 == 0 ? LCD_WIDTH : 1 + rand() % 40;
+        uint16_t    h     = rand() % 8 == 0 ? LCD_HEIGHT : 1 + rand() % 40;
+        uint16_t    l     = rand() % (LCD_WIDTH - w + 1);
+        uint16_t    t     = rand() % (LCD_HEIGHT - h + 1);
+        hlc_pixel_t color = hlc_palette[rand() % HLC_COLOR_COUNT];
+
+        for (uint16_t y = t; y < t + h; y++) {
+            for (uint16_t x = l; x < l + w; x++) {
+                framebuffer[y * LCD_WIDTH + x] = color;
+            }
+        }
+
+        if (rand() % 2) {
+            hlc_dirty_mark(l, t, l + w - 1, t + h - 1);
+        } else if (!surface.dirty.is_dirty) {
+            surface.dirty = (surface_dirty_data_t){true, l, t, l + w - 1, t + h - 1};
+        } else {
+            surface.dirty.l = MIN(surface.dirty.l, l);
+            surface.dirty.t = MIN(surface.dirty.t, t);
+            surface.dirty.r = MAX(surface.dirty.r, l + w - 1);
+            surface.dirty.b = MAX(surface.dirty.b, t + h - 1);
+        }
+    }
+}
+
+// Runs the flush task until it's done, the DMA finishes a transfer now and then in between
+static void flush(void) {
+#ifdef HLC_TFT_STRIP_RENDER
+    const hlc_pixel_t *source = NULL;
+#else
+    const hlc_pixel_t *source = framebuffer;
+#endif
+    uint32_t calls = 0;
+
+    if (!hlc_spi_flush_start(&surface, &lcd_device, source)) {
+        ERROR("flush refused with nothing in progress\n");
+    }
+    while (hlc_spi_flush_in_progress()) {
+        if (calls == 1 && hlc_spi_flush_start(&surface, &lcd_device, source)) {
+            ERROR("second flush started while one is in progress\n");
+        }
+        if (rand() % 3 == 0) {
+            complete_transfer();
+        }
+        hlc_spi_flush_task();
+        if (++calls > MAX_TASK_CALLS) {
+            ERROR("flush never finished\n");
+            break;
+        }
+    }
+    max_task_calls = MAX(max_task_calls, calls);
+
+    if (SPI_DRIVER.state == SPI_ACTIVE || bus.started) {
+        ERROR("flush done with %s\n", bus.started ? "the bus held" : "a transfer running");
+        complete_transfer();
+        bus.started = false;
+    }
+}
+
+// Pixels the display got wrong have to be dirty, the next flush sends them
+static void check_display(void) {
+#ifdef HLC_TFT_STRIP_RENDER
+    hlc_rect_t windows[HLC_DIRTY_MAX_BANDS];
+    uint8_t    count = hlc_dirty_plan_bands(windows);
+#else
+    hlc_rect_t windows[HLC_DIRTY_MAX_RECTS];
+    uint8_t    count = hlc_dirty_plan(windows);
+#endif
+
+    for (uint32_t i = 0; i < PIXELS; i++) {
+        uint16_t x = i % LCD_WIDTH, y = i / LCD_WIDTH;
+        bool     dirty = false;
+
+        for (uint8_t w = 0; w < count; w++) {
+            dirty |= x >= windows[w].l && x <= windows[w].r && y >= windows[w].t && y <= windows[w].b;
+        }
+        if (!dirty && display[i] != native_pixel(i)) {
+            ERROR("pixel %u,%u is wrong on the display and not dirty\n", x, y);
+            break;
+        }
+    }
+}
+
+int main(void) {
+    srand(1);
+    hlc_raster_init_palette();
+    surface.width  = LCD_WIDTH;
+    surface.height = LCD_HEIGHT;
+
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        faulty = frame >= (FRAMES - FAULTY_FRAMES) / 2 && frame < (FRAMES + FAULTY_FRAMES) / 2;
+        draw_changes();
+        flush();
+        check_display();
+    }
+
+    // Whatever was left dirty goes out
+    faulty = false;
+    flush();
+    for (uint32_t i = 0; i < PIXELS; i++) {
+        if (display[i] != native_pixel(i)) {
+            ERROR("pixel %u,%u differs at the end\n", i % LCD_WIDTH, i / LCD_WIDTH);
+            break;
+        }
+    }
+
+    printf("%u frames: %u windows, %u transfers, %.0f bytes per transfer (max %u), %u busy, up to %u task calls per flush, %u errors\n", FRAMES, windows, transfers, transfers ? (double)bytes / transfers : 0, max_transfer, busy, max_task_calls, errors);
+    return errors != 0;
+}
@@ -0,0 +1,55 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's action.h and the rest of quantum.h that comes with it, the tests implement the calls
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "gpio.h"
+#include "timer.h"
+#include "util.h"
+
+#define QK_KB_1 0x7E01
+
+typedef uint32_t layer_state_t;
+
+typedef union {
+    uint8_t raw;
+    struct {
+        bool    num_lock : 1;
+        bool    caps_lock : 1;
+        bool    scroll_lock : 1;
+        bool    compose : 1;
+        bool    kana : 1;
+        uint8_t reserved : 3;
+    };
+} led_t;
+
+typedef union {
+    uint8_t raw;
+    struct {
+        bool    enable : 1;
+        bool    breathing : 1;
+        uint8_t reserved : 1;
+        uint8_t level : 5;
+    };
+} backlight_config_t;
+
+typedef struct {
+    struct {
+        bool pressed;
+    } event;
+} keyrecord_t;
+
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+uint8_t  get_highest_layer(layer_state_t state);
+led_t    host_keyboard_led_state(void);
+uint32_t last_matrix_activity_time(void);
+uint32_t last_input_activity_elapsed(void);
+void     backlight_enable(void);
+void     suspend_power_down_user(void);
+void     suspend_wakeup_init_user(void);
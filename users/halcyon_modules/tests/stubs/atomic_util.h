@@ -0,0 +1,7 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's atomic_util.h, the tests that run threads don't rely on it
+#pragma once
+
+#define ATOMIC_BLOCK_FORCEON for (int atomic_block_once = 1; atomic_block_once; atomic_block_once = 0)
@@ -0,0 +1,27 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for ChibiOS' ch.h, the system time is a 1 MHz counter the tests set (CH_CFG_ST_FREQUENCY of the RP2040)
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t systime_t;
+typedef uint32_t sysinterval_t;
+
+extern systime_t test_system_time;
+
+#define TIME_I2US(interval) ((uint32_t)(interval))
+#define TIME_US2I(usecs) ((sysinterval_t)(usecs))
+#define TIME_MS2I(msecs) ((sysinterval_t)(msecs) * 1000)
+#define TIME_I2MS(interval) ((uint32_t)(interval) / 1000)
+
+#define chTimeDiffX(start, end) ((sysinterval_t)((end) - (start)))
+
+static inline systime_t chVTGetSystemTimeX(void) {
+    return test_system_time;
+}
+
+static inline sysinterval_t chVTTimeElapsedSinceX(systime_t start) {
+    return chTimeDiffX(start, chVTGetSystemTimeX());
+}
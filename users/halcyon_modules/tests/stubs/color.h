@@ -0,0 +1,62 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's color.h, the HSV to RGB conversion is QMK's without the CIE curve
+#pragma once
+
+#include <stdint.h>
+
+#define HSV_WHITE 0, 0, 255
+#define HSV_BLACK 0, 0, 0
+
+typedef struct {
+    uint8_t h;
+    uint8_t s;
+    uint8_t v;
+} hsv_t;
+
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} rgb_t;
+
+static inline rgb_t hsv_to_rgb_nocie(hsv_t hsv) {
+    rgb_t   rgb;
+    uint8_t region, remainder, p, q, t;
+
+    if (hsv.s == 0) {
+        rgb.r = rgb.g = rgb.b = hsv.v;
+        return rgb;
+    }
+
+    region    = hsv.h * 6 / 255;
+    remainder = (hsv.h * 2 - region * 85) * 3;
+
+    p = (hsv.v * (255 - hsv.s)) >> 8;
+    q = (hsv.v * (255 - ((hsv.s * remainder) >> 8))) >> 8;
+    t = (hsv.v * (255 - ((hsv.s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 6:
+        case 0:
+            rgb = (rgb_t){hsv.v, t, p};
+            break;
+        case 1:
+            rgb = (rgb_t){q, hsv.v, p};
+            break;
+        case 2:
+            rgb = (rgb_t){p, hsv.v, t};
+            break;
+        case 3:
+            rgb = (rgb_t){p, q, hsv.v};
+            break;
+        case 4:
+            rgb = (rgb_t){t, p, hsv.v};
+            break;
+        default:
+            rgb = (rgb_t){hsv.v, p, q};
+            break;
+    }
+    return rgb;
+}
@@ -0,0 +1,13 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's debounce.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "matrix.h"
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+void debounce_init(uint8_t num_rows);
+void debounce_free(void);
@@ -0,0 +1,14 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's debug.h
+#pragma once
+
+#include <stdbool.h>
+#include "print.h"
+
+extern bool debug_matrix;
+
+#define dprintf(...) \
+    do {             \
+    } while (0)
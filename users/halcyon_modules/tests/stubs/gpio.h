@@ -0,0 +1,22 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's gpio.h, the tests that drive pins implement these
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint32_t pin_t;
+
+#define NO_PIN ((pin_t)0xFFFFFFFF)
+#define PAL_PAD(pin) ((pin) & 31)
+
+void gpio_set_pin_input_high(pin_t pin);
+void gpio_set_pin_output(pin_t pin);
+void gpio_write_pin_low(pin_t pin);
+void gpio_write_pin_high(pin_t pin);
+bool gpio_read_pin(pin_t pin);
+
+#define setPinOutput(pin) gpio_set_pin_output(pin)
+#define writePinHigh(pin) gpio_write_pin_high(pin)
@@ -0,0 +1,34 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for the parts of ChibiOS' hal.h for the RP2040 the modules use. WFE becomes a yield, the tests
+// running a second core as a thread poll instead of sleeping.
+#pragma once
+
+#include <sched.h>
+#include <stdint.h>
+#include "ch.h"
+
+typedef struct {
+    volatile uint32_t FIFO_ST;
+    volatile uint32_t FIFO_WR;
+    volatile uint32_t FIFO_RD;
+} SIO_TypeDef;
+
+typedef struct {
+    volatile uint32_t VTOR;
+} SCB_Type;
+
+extern SIO_TypeDef hal_sio;
+extern SCB_Type    hal_scb;
+
+#define SIO (&hal_sio)
+#define SCB (&hal_scb)
+
+#define SIO_FIFO_ST_VLD (1 << 0)
+#define SIO_FIFO_ST_RDY (1 << 1)
+
+#define __WFE() sched_yield()
+#define __SEV() \
+    do {        \
+    } while (0)
@@ -0,0 +1,32 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's matrix.h, sized like a Halcyon board with a module: 5 rows per half, 7 columns
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef MATRIX_ROWS
+#    define MATRIX_ROWS 10
+#endif
+#ifndef MATRIX_COLS
+#    define MATRIX_COLS 7
+#endif
+
+#if MATRIX_COLS <= 8
+typedef uint8_t matrix_row_t;
+#elif MATRIX_COLS <= 16
+typedef uint16_t matrix_row_t;
+#else
+typedef uint32_t matrix_row_t;
+#endif
+
+#define MATRIX_ROW_SHIFTER ((matrix_row_t)1)
+
+void matrix_output_select_delay(void);
+void matrix_output_unselect_delay(uint8_t line, bool key_pressed);
+
+#ifdef MATRIX_MASKED
+extern const matrix_row_t matrix_mask[];
+#endif
@@ -0,0 +1,17 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's pointing_device.h
+#pragma once
+
+#include "report.h"
+
+#ifdef MOUSE_EXTENDED_REPORT
+#    define XY_REPORT_MIN INT16_MIN
+#    define XY_REPORT_MAX INT16_MAX
+#else
+#    define XY_REPORT_MIN INT8_MIN
+#    define XY_REPORT_MAX INT8_MAX
+#endif
+
+report_mouse_t pointing_device_task_kb(report_mouse_t mouse_report);
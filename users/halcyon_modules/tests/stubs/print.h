@@ -0,0 +1,9 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's print.h, the console is stdout
+#pragma once
+
+#include <stdio.h>
+
+#define uprintf(...) printf(__VA_ARGS__)
@@ -0,0 +1,48 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for Quantum Painter's qp.h, the tests implement the calls they need
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "color.h"
+#include "gpio.h"
+
+typedef const void *painter_device_t;
+
+typedef enum {
+    QP_ROTATION_0,
+    QP_ROTATION_90,
+    QP_ROTATION_180,
+    QP_ROTATION_270,
+} painter_rotation_t;
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+} painter_image_descriptor_t;
+
+typedef struct {
+    uint8_t line_height;
+} painter_font_descriptor_t;
+
+typedef const painter_image_descriptor_t *painter_image_handle_t;
+typedef const painter_font_descriptor_t  *painter_font_handle_t;
+
+bool qp_init(painter_device_t device, painter_rotation_t rotation);
+bool qp_power(painter_device_t device, bool power_on);
+bool qp_flush(painter_device_t device);
+void qp_set_viewport_offsets(painter_device_t device, uint16_t offset_x, uint16_t offset_y);
+bool qp_viewport(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom);
+bool qp_pixdata(painter_device_t device, const void *pixel_data, uint32_t native_pixel_count);
+bool qp_rect(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, uint8_t hue, uint8_t sat, uint8_t val, bool filled);
+
+// Images and fonts, for the QFF/QGF runtime decode (HLC_TFT_NATIVE_ASSETS off)
+painter_image_handle_t qp_load_image_mem(const void *buffer);
+bool                   qp_close_image(painter_image_handle_t image);
+bool                   qp_drawimage_recolor(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg);
+painter_font_handle_t  qp_load_font_mem(const void *buffer);
+int16_t                qp_drawtext_recolor(painter_device_t device, uint16_t x, uint16_t y, painter_font_handle_t font, const char *str, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg);
+
+painter_device_t qp_st7789_make_spi_device(uint16_t panel_width, uint16_t panel_height, pin_t chip_select_pin, pin_t dc_pin, pin_t reset_pin, uint16_t spi_divisor, int spi_mode);
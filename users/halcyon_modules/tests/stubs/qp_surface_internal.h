@@ -0,0 +1,20 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for Quantum Painter's qp_surface_internal.h, only the dirty box the modules take over
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "qp.h"
+
+typedef struct {
+    bool     is_dirty;
+    uint16_t l, t, r, b;
+} surface_dirty_data_t;
+
+typedef struct {
+    uint16_t             width;
+    uint16_t             height;
+    surface_dirty_data_t dirty;
+} surface_painter_device_t;
@@ -0,0 +1,12 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's quantum.h, the little the modules take from it
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "util.h"
+
+#define PACKED __attribute__((packed))
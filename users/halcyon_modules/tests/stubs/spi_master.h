@@ -0,0 +1,32 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's spi_master.h and the ChibiOS SPI driver under it, the tests implement the calls
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gpio.h"
+
+typedef enum {
+    SPI_UNINIT,
+    SPI_STOP,
+    SPI_READY,
+    SPI_ACTIVE,
+    SPI_COMPLETE,
+} spistate_t;
+
+typedef struct {
+    volatile spistate_t state;
+} SPIDriver;
+
+extern SPIDriver SPID0;
+
+#ifndef SPI_DRIVER
+#    define SPI_DRIVER SPID0
+#endif
+
+bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor);
+void spi_stop(void);
+void spiStartSend(SPIDriver *spip, size_t n, const void *txbuf);
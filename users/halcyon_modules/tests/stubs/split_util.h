@@ -0,0 +1,14 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's split_util.h, the tests pick the half
+#pragma once
+
+#include <stdbool.h>
+#include "matrix.h"
+
+extern volatile bool isLeftHand;
+
+bool is_keyboard_left(void);
+bool is_keyboard_master(void);
+bool is_transport_connected(void);
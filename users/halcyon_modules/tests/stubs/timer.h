@@ -0,0 +1,36 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's timer.h, the tests move the clock themselves
+#pragma once
+
+#include <stdint.h>
+
+extern uint32_t test_timer_ms;
+
+#define TIMER_DIFF_16(a, b) (uint16_t)((a) - (b))
+#define TIMER_DIFF_32(a, b) (uint32_t)((a) - (b))
+
+static inline uint16_t timer_read(void) {
+    return (uint16_t)test_timer_ms;
+}
+
+static inline uint32_t timer_read32(void) {
+    return test_timer_ms;
+}
+
+static inline uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+static inline uint32_t timer_elapsed32(uint32_t last) {
+    return TIMER_DIFF_32(timer_read32(), last);
+}
+
+typedef uint16_t fast_timer_t;
+
+#define TIMER_DIFF_FAST(a, b) TIMER_DIFF_16(a, b)
+
+static inline fast_timer_t timer_read_fast(void) {
+    return timer_read();
+}
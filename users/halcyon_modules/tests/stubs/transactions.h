@@ -0,0 +1,23 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's transactions.h, the tests implement the RPC calls
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SPLIT_TRANSACTION_IDS_KB
+#    define SPLIT_TRANSACTION_IDS_KB MODULE_SYNC, POINTING_SYNC
+#endif
+
+enum serial_transaction_id {
+    GET_RPC_RESP,
+    SPLIT_TRANSACTION_IDS_KB,
+    NUM_TOTAL_TRANSACTIONS,
+};
+
+typedef void (*slave_callback_t)(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
+
+void transaction_register_rpc(int8_t transaction_id, slave_callback_t callback);
+bool transaction_rpc_exec(int8_t transaction_id, uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer);
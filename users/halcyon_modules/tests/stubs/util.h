@@ -0,0 +1,14 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host stand-in for QMK's util.h
+#pragma once
+
+#define ARRAY_SIZE(array) (sizeof((array)) / sizeof((array)[0]))
+
+#ifndef MIN
+#    define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+#ifndef MAX
+#    define MAX(x, y) (((x) > (y)) ? (x) : (y))
+#endif
@@ -0,0 +1,19 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Board config for the TFT display tests, included ahead of the module sources like QMK's generated config would be.
+// The pins are plain numbers on the host.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gpio.h"
+
+#define GP13 13
+#define GP16 16
+#define GP26 26
+#define GP27 27
+
+#define HLC_BACKLIGHT_TIMEOUT 120000 // As in ../config.h, which only builds in QMK
+
+#include "hlc_tft_display/config.h"
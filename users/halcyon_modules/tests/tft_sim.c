@@ -0,0 +1,662 @@
+// Copyright 2024 splitkb.com (support@splitkb.com)
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Host simulator of the TFT display module: hlc_tft_display.c and everything under it run against stand-ins for
+// Quantum Painter and the SPI bus that paint into a copy of the ST7789's memory, with the clocks moved by the script.
+//
+// Three scripted phases, each timed per call (HLC_BENCH zones, in ns on the host) and compared with a golden image:
+// - status:  the main half's layer number and lock indicators, STATUS_TICKS housekeeping ticks with the layer and
+//            the LEDs changing.
+// - bench:   the HLC_TFT_BENCH script of hlc_tft_display.c (HLC_TFT_BENCH_FRAMES Life frames with the status drawn
+//            over them), as it runs on the keyboard.
+// - life:    the second half's Game of Life, LIFE_TICKS ticks with a key pressed now and then.
+// The flush zone times what the display code sends, the dirty tile flush that replaced qp_surface_draw().
+// With an RGB565 surface every cell of a random grid is then redrawn GRID_REDRAWS times with draw_grid() and with the
+// qp_rect drawing it replaced, on a model of Quantum Painter's surface fill. Both have to leave the same framebuffer.
+//
+// rand() is newlib's, so the bench frames are the ones the keyboard draws and its CRC matches the console output.
+// The images are what was sent to the display, stored as PPM in golden/. They are written by tft_sim_qp (`make golden`),
+// the build without HLC_TFT_NATIVE_ASSETS that decodes the QFF/QGF files at runtime through the Quantum Painter
+// stand-ins below. The native assets and every framebuffer format have to produce the same images. The strip renderer has its own in golden/strip/: it reads the
+// cells from the grid when they are sent, so it shows the newest generation and every cell in the current colour.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "halcyon.h"
+#include "ch.h"
+#include "hlc_tft_display.h"
+#include "hlc_tft_dirty.h"
+#include "hlc_tft_life.h"
+#include "hlc_tft_bench.h"
+#include "qp_surface.h"
+#include "qp_surface_internal.h"
+#include "spi_master.h"
+
+#define STATUS_TICKS 4000
+#define LIFE_TICKS 30000
+#define KEY_EVERY_MS 1500
+#define GRID_REDRAWS 2000
+#define PIXDATA_BUFFER_SIZE 1024 // QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE
+
+#define PIXELS (LCD_WIDTH * LCD_HEIGHT)
+
+uint32_t      test_timer_ms;
+systime_t     test_system_time;
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+bool          backlight_off;
+SPIDriver     SPID0 = {.state = SPI_READY};
+
+static const char *golden_dir;
+static bool        update_golden;
+static const char *sim_name;
+static uint32_t    failures;
+
+static led_t    led_state;
+static uint32_t activity_time;
+
+// The ST7789's memory, in the byte order it is sent
+static struct {
+    uint16_t   pixels[PIXELS];
+    hlc_rect_t window;
+    uint32_t   cursor;
+    uint32_t   windows;
+    uint64_t   bytes;
+} lcd_mock;
+
+static const int                lcd_device;
+static surface_painter_device_t surface_device;
+
+// What Quantum Painter's RGB565 surface keeps on top of the dirty box
+static struct {
+    uint16_t  *buffer;
+    hlc_rect_t viewport;
+    uint16_t   x, y;
+} surface_mock;
+
+// newlib's rand(), the one the keyboard runs
+static uint64_t rand_next = 1;
+
+void srand(unsigned int seed) {
+    rand_next = seed;
+}
+
+int rand(void) {
+    rand_next = rand_next * 6364136223846793005ULL + 1;
+    return (int)((rand_next >> 32) & RAND_MAX);
+}
+
+// The second half seeds Life with the time of day
+time_t time(time_t *result) {
+    if (result != NULL) {
+        *result = 0;
+    }
+    return 0;
+}
+
+// Timing zones
+
+static const char *const zone_names[HLC_BENCH_COUNT] = {
+    [HLC_BENCH_UPDATE_GRID]    = "update_grid",
+    [HLC_BENCH_DRAW_GRID]      = "draw_grid",
+    [HLC_BENCH_DRAW_STATUS]    = "draw_status",
+    [HLC_BENCH_UPDATE_DISPLAY] = "update_display",
+    [HLC_BENCH_FLUSH]          = "flush",
+};
+
+static struct {
+    uint32_t calls;
+    uint64_t total_ns;
+    uint32_t max_ns;
+} zones[HLC_BENCH_COUNT];
+
+static uint32_t bench_crc;
+static bool     bench_reported;
+
+uint32_t hlc_bench_begin(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+void hlc_bench_end(hlc_bench_zone_t zone, uint32_t start) {
+    uint32_t elapsed = hlc_bench_begin() - start;
+
+    zones[zone].calls++;
+    zones[zone].total_ns += elapsed;
+    zones[zone].max_ns = MAX(zones[zone].max_ns, elapsed);
+}
+
+void hlc_bench_reset(void) {
+    memset(zones, 0, sizeof(zones));
+    lcd_mock.windows = 0;
+    lcd_mock.bytes   = 0;
+}
+
+// Same checksum as the keyboard prints
+uint32_t hlc_bench_crc32(uint32_t crc, const void *data, size_t length) {
+    const uint8_t *bytes = data;
+
+    crc = ~crc;
+    while (length--) {
+        crc ^= *bytes++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// Images
+
+// Native RGB565 is byte swapped, channels are widened like a PNG converter would
+static void write_ppm(const char *path) {
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL) {
+        perror(path);
+        failures++;
+        return;
+    }
+    fprintf(file, "P6\n%u %u\n255\n", LCD_WIDTH, LCD_HEIGHT);
+    for (uint32_t i = 0; i < PIXELS; i++) {
+        uint16_t rgb565 = __builtin_bswap16(lcd_mock.pixels[i]);
+        uint8_t  r = rgb565 >> 11, g = (rgb565 >> 5) & 0x3F, b = rgb565 & 0x1F;
+        uint8_t  rgb[3] = {(uint8_t)(r << 3 | r >> 2), (uint8_t)(g << 2 | g >> 4), (uint8_t)(b << 3 | b >> 2)};
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    fclose(file);
+}
+
+static bool read_file(const char *path, uint8_t *data, size_t size, size_t *length) {
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+    *length = fread(data, 1, size, file);
+    fclose(file);
+    return true;
+}
+
+// Writes what the display shows next to the binary and compares it with the golden image
+static void check_image(const char *name) {
+    static uint8_t actual[PIXELS * 3 + 32], golden[PIXELS * 3 + 32];
+    char           actual_path[256], golden_path[256];
+    size_t         actual_length, golden_length;
+
+    snprintf(actual_path, sizeof(actual_path), "%s_%s.ppm", sim_name, name);
+    snprintf(golden_path, sizeof(golden_path), "%s/%s.ppm", golden_dir, name);
+    write_ppm(actual_path);
+    if (update_golden) {
+        write_ppm(golden_path);
+        printf("  %s written\n", golden_path);
+        return;
+    }
+
+    if (!read_file(actual_path, actual, sizeof(actual), &actual_length) || !read_file(golden_path, golden, sizeof(golden), &golden_length)) {
+        printf("  %s: no golden image\n", golden_path);
+        failures++;
+        return;
+    }
+
+    uint32_t differ = 0, first = 0;
+    for (size_t i = 0; i < MIN(actual_length, golden_length); i++) {
+        if (actual[i] != golden[i] && differ++ == 0) {
+            first = i;
+        }
+    }
+    if (differ || actual_length != golden_length) {
+        printf("  %s differs from %s in %u bytes, the first at %u\n", actual_path, golden_path, differ, first);
+        failures++;
+    } else {
+        printf("  %s matches %s\n", actual_path, golden_path);
+    }
+}
+
+static void report(const char *phase, uint32_t count, const char *unit) {
+    printf("%s: %u %s, %u windows, %.1f kB sent to the display\n", phase, count, unit, lcd_mock.windows, lcd_mock.bytes / 1024.0);
+    printf("  %-14s %8s %12s %10s %10s\n", "zone", "calls", "total us", "avg ns", "max ns");
+    for (uint8_t i = 0; i < HLC_BENCH_COUNT; i++) {
+        if (zones[i].calls) {
+            printf("  %-14s %8u %12.0f %10.0f %10u\n", zone_names[i], zones[i].calls, zones[i].total_ns / 1000.0, (double)zones[i].total_ns / zones[i].calls, zones[i].max_ns);
+        }
+    }
+}
+
+// Called by the bench script once its frames are on the display
+void hlc_bench_report(uint32_t crc) {
+    bench_crc      = crc;
+    bench_reported = true;
+    report("bench", HLC_TFT_BENCH_FRAMES, "frames");
+    printf("  framebuffer crc %08x (seed %u)\n", crc, HLC_TFT_BENCH_SEED);
+    check_image("bench");
+}
+
+// The display and the bus
+
+static void lcd_write(const uint16_t *pixels, uint32_t count) {
+    uint16_t width = lcd_mock.window.r - lcd_mock.window.l + 1;
+    uint32_t area  = (uint32_t)width * (lcd_mock.window.b - lcd_mock.window.t + 1);
+
+    for (uint32_t i = 0; i < count && lcd_mock.cursor < area; i++, lcd_mock.cursor++) {
+        lcd_mock.pixels[(lcd_mock.window.t + lcd_mock.cursor / width) * LCD_WIDTH + lcd_mock.window.l + lcd_mock.cursor % width] = pixels[i];
+    }
+    lcd_mock.bytes += count * sizeof(uint16_t);
+}
+
+painter_device_t qp_st7789_make_spi_device(uint16_t panel_width, uint16_t panel_height, pin_t chip_select_pin, pin_t dc_pin, pin_t reset_pin, uint16_t spi_divisor, int spi_mode) {
+    return &lcd_device;
+}
+
+painter_device_t qp_make_rgb565_surface(uint16_t panel_width, uint16_t panel_height, void *buffer) {
+    surface_device.width  = panel_width;
+    surface_device.height = panel_height;
+    surface_mock.buffer   = buffer;
+    return &surface_device;
+}
+
+bool qp_init(painter_device_t device, painter_rotation_t rotation) {
+    return true;
+}
+
+bool qp_power(painter_device_t device, bool power_on) {
+    return true;
+}
+
+bool qp_flush(painter_device_t device) {
+    return true;
+}
+
+void qp_set_viewport_offsets(painter_device_t device, uint16_t offset_x, uint16_t offset_y) {}
+
+bool qp_viewport(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    if (device != &lcd_device) {
+        return false;
+    }
+    lcd_mock.window = (hlc_rect_t){left, top, right, bottom};
+    lcd_mock.cursor = 0;
+    lcd_mock.windows++;
+    return true;
+}
+
+bool qp_pixdata(painter_device_t device, const void *pixel_data, uint32_t native_pixel_count) {
+    lcd_write(pixel_data, native_pixel_count);
+    return device == &lcd_device;
+}
+
+// Quantum Painter's filled rect on an RGB565 surface: the colour is converted on every call, the rect becomes the
+// viewport and a buffer of the colour is streamed into it pixel by pixel, growing the dirty box. Off-surface pixels
+// are dropped.
+static void surface_stream(const uint16_t *pixels, uint32_t count) {
+    surface_dirty_data_t *dirty = &surface_device.dirty;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (surface_mock.x < surface_device.width && surface_mock.y < surface_device.height) {
+            surface_mock.buffer[surface_mock.y * surface_device.width + surface_mock.x] = pixels[i];
+            dirty->l        = MIN(dirty->l, surface_mock.x);
+            dirty->t        = MIN(dirty->t, surface_mock.y);
+            dirty->r        = MAX(dirty->r, surface_mock.x);
+            dirty->b        = MAX(dirty->b, surface_mock.y);
+            dirty->is_dirty = true;
+        }
+        if (++surface_mock.x > surface_mock.viewport.r) {
+            surface_mock.x = surface_mock.viewport.l;
+            surface_mock.y++;
+        }
+    }
+}
+
+static void surface_rect(uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, uint16_t native) {
+    static uint16_t pixdata[PIXDATA_BUFFER_SIZE / sizeof(uint16_t)];
+    uint32_t        remaining = (uint32_t)(right - left + 1) * (bottom - top + 1);
+    uint32_t        filled    = MIN(remaining, ARRAY_SIZE(pixdata));
+
+    surface_mock.viewport = (hlc_rect_t){left, top, right, bottom};
+    surface_mock.x        = left;
+    surface_mock.y        = top;
+    for (uint32_t i = 0; i < filled; i++) {
+        pixdata[i] = native;
+    }
+    while (remaining > 0) {
+        uint32_t count = MIN(remaining, filled);
+        surface_stream(pixdata, count);
+        remaining -= count;
+    }
+}
+
+// Quantum Painter's conversion of a colour to the byte swapped RGB565 of the surface and the ST7789
+static uint16_t native_color(uint8_t hue, uint8_t sat, uint8_t val) {
+    rgb_t rgb = hsv_to_rgb_nocie((hsv_t){hue, sat, val});
+    return __builtin_bswap16((uint16_t)((rgb.r >> 3) << 11 | (rgb.g >> 2) << 5 | (rgb.b >> 3)));
+}
+
+// Clears the display at boot, and is what the Life grid was drawn with before the rasterizer
+bool qp_rect(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom, uint8_t hue, uint8_t sat, uint8_t val, bool filled) {
+    uint16_t native = native_color(hue, sat, val);
+
+    if (device == &surface_device) {
+        surface_rect(left, top, right, bottom, native);
+        return true;
+    }
+    for (uint16_t y = top; y <= bottom; y++) {
+        for (uint16_t x = left; x <= right; x++) {
+            lcd_mock.pixels[y * LCD_WIDTH + x] = native;
+        }
+    }
+    return device == &lcd_device;
+}
+
+#ifndef HLC_TFT_NATIVE_ASSETS
+// Quantum Painter's QGF images and QFF fonts, for the runtime decode the native assets replaced. Only what the
+// display's mono2 graphics use: 1bpp pixels, LSB first without row padding, optionally RLE compressed, drawn with a
+// two entry palette of the background and foreground colour. Every glyph and image is its own viewport on the surface.
+
+typedef struct {
+    painter_image_descriptor_t base;
+    bool                       compressed;
+    const uint8_t             *pixels;
+} sim_image_t;
+
+typedef struct {
+    painter_font_descriptor_t base;
+    bool                      compressed;
+    const uint8_t            *ascii;  // 3 bytes per glyph from ' ' on: 6 bit width, 18 bit offset into glyphs
+    const uint8_t            *glyphs; // Every glyph is compressed on its own
+} sim_font_t;
+
+static sim_image_t sim_images[2];
+static sim_font_t  sim_fonts[2];
+static uint8_t     sim_fonts_used;
+
+typedef struct {
+    const uint8_t *data;
+    bool           compressed;
+    bool           repeat;
+    uint8_t        left;
+} qp_reader_t;
+
+static inline uint32_t read_le(const uint8_t *data, uint8_t bytes) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bytes; i++) {
+        value |= (uint32_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+// Payload of a block of the file: type id, inverted type id, 24 bit length. The first block has the file size.
+static const uint8_t *find_block(const uint8_t *file, uint8_t type) {
+    uint32_t size = read_le(&file[9], 4);
+
+    for (uint32_t offset = 0; offset + 5 <= size; offset += 5 + read_le(&file[offset + 2], 3)) {
+        if (file[offset] == type && (file[offset] ^ file[offset + 1]) == 0xFF) {
+            return &file[offset + 5];
+        }
+    }
+    return NULL;
+}
+
+// QP RLE: a marker below 128 repeats the next byte that many times, otherwise (marker - 127) literal bytes follow
+static uint8_t read_byte(qp_reader_t *reader) {
+    if (!reader->compressed) {
+        return *reader->data++;
+    }
+    if (reader->left == 0) {
+        uint8_t marker = *reader->data++;
+        reader->repeat = marker < 128;
+        reader->left   = reader->repeat ? marker : marker - 127;
+    }
+    reader->left--;
+    return (reader->repeat && reader->left) ? *reader->data : *reader->data++;
+}
+
+static void draw_mono(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *pixels, bool compressed, uint16_t fg, uint16_t bg) {
+    qp_reader_t reader = {.data = pixels, .compressed = compressed};
+    uint8_t     byte   = 0;
+
+    surface_mock.viewport = (hlc_rect_t){x, y, x + width - 1, y + height - 1};
+    surface_mock.x        = x;
+    surface_mock.y        = y;
+    for (uint32_t i = 0; i < (uint32_t)width * height; i++) {
+        if (i % 8 == 0) {
+            byte = read_byte(&reader);
+        }
+        uint16_t pixel = (byte >> (i % 8)) & 1 ? fg : bg;
+        surface_stream(&pixel, 1);
+    }
+}
+
+painter_image_handle_t qp_load_image_mem(const void *buffer) {
+    const uint8_t *descriptor = find_block(buffer, 0x00);
+    const uint8_t *frame      = find_block(buffer, 0x02);
+    const uint8_t *pixels     = find_block(buffer, 0x05);
+
+    // mono2 only
+    if (descriptor == NULL || frame == NULL || pixels == NULL || frame[0] != 0x00) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < ARRAY_SIZE(sim_images); i++) {
+        if (sim_images[i].pixels == NULL) {
+            sim_images[i] = (sim_image_t){{read_le(&descriptor[12], 2), read_le(&descriptor[14], 2)}, frame[2] == 0x01, pixels};
+            return &sim_images[i].base;
+        }
+    }
+    return NULL;
+}
+
+bool qp_close_image(painter_image_handle_t image) {
+    ((sim_image_t *)image)->pixels = NULL;
+    return true;
+}
+
+bool qp_drawimage_recolor(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg) {
+    const sim_image_t *sim = (const sim_image_t *)image;
+
+    if (device != &surface_device) {
+        return false;
+    }
+    draw_mono(x, y, image->width, image->height, sim->pixels, sim->compressed, native_color(hue_fg, sat_fg, val_fg), native_color(hue_bg, sat_bg, val_bg));
+    return true;
+}
+
+painter_font_handle_t qp_load_font_mem(const void *buffer) {
+    const uint8_t *descriptor = find_block(buffer, 0x00);
+    const uint8_t *ascii      = find_block(buffer, 0x01);
+    const uint8_t *glyphs     = find_block(buffer, 0x04);
+
+    // mono2 with an ASCII table only
+    if (descriptor == NULL || ascii == NULL || glyphs == NULL || descriptor[16] != 0x00 || sim_fonts_used == ARRAY_SIZE(sim_fonts)) {
+        return NULL;
+    }
+    sim_fonts[sim_fonts_used] = (sim_font_t){{descriptor[12]}, descriptor[18] == 0x01, ascii, glyphs};
+    return &sim_fonts[sim_fonts_used++].base;
+}
+
+// Returns the width of the text
+int16_t qp_drawtext_recolor(painter_device_t device, uint16_t x, uint16_t y, painter_font_handle_t font, const char *str, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg) {
+    const sim_font_t *sim   = (const sim_font_t *)font;
+    uint16_t          fg    = native_color(hue_fg, sat_fg, val_fg);
+    uint16_t          bg    = native_color(hue_bg, sat_bg, val_bg);
+    uint16_t          start = x;
+
+    if (device != &surface_device) {
+        return 0;
+    }
+    for (; *str; str++) {
+        uint32_t glyph = read_le(&sim->ascii[(*str - ' ') * 3], 3);
+        uint8_t  width = glyph & 0x3F;
+        draw_mono(x, y, width, font->line_height, &sim->glyphs[glyph >> 6], sim->compressed, fg, bg);
+        x += width;
+    }
+    return x - start;
+}
+#endif
+
+// The DMA is done as soon as it starts
+bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
+    return true;
+}
+
+void spi_stop(void) {}
+
+void spiStartSend(SPIDriver *spip, size_t n, const void *txbuf) {
+    lcd_write(txbuf, n / sizeof(uint16_t));
+}
+
+void gpio_set_pin_output(pin_t pin) {}
+void gpio_write_pin_high(pin_t pin) {}
+
+// The keyboard
+
+uint8_t get_highest_layer(layer_state_t state) {
+    return state ? 31 - __builtin_clz(state) : 0;
+}
+
+led_t host_keyboard_led_state(void) {
+    return led_state;
+}
+
+uint32_t last_matrix_activity_time(void) {
+    return activity_time;
+}
+
+uint32_t last_input_activity_elapsed(void) {
+    return test_timer_ms - activity_time;
+}
+
+void backlight_enable(void) {}
+void suspend_power_down_user(void) {}
+void suspend_wakeup_init_user(void) {}
+
+bool module_post_init_user(void) {
+    return true;
+}
+
+bool display_module_housekeeping_task_user(bool second_display) {
+    return true;
+}
+
+#if !defined(HLC_TFT_INDEXED_FB) && !defined(HLC_TFT_STRIP_RENDER)
+// Full Life grid redraws
+
+extern int color_value;
+
+// draw_grid() before hlc_raster_life_row(): a black 6x6 rect per changed cell, the cell's colour on top when it lives
+static void qp_rect_draw_grid(void) {
+    static const hsv_t colors[] = {{HSV_LAYER_0}, {HSV_LAYER_1}, {HSV_LAYER_2}, {HSV_LAYER_3}, {HSV_LAYER_4}, {HSV_LAYER_5}, {HSV_LAYER_6}, {HSV_LAYER_7}, {HSV_LAYER_UNDEF}};
+    hsv_t               color    = colors[(color_value >= 0 && color_value < 8) ? color_value : 8];
+
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+        uint32_t changed = life_changed[y];
+        while (changed) {
+            int x = __builtin_ctz(changed);
+            changed &= changed - 1;
+            uint16_t left   = x * 5;
+            uint16_t top    = y * 5;
+            uint16_t right  = left + 5;
+            uint16_t bottom = top + 5;
+
+            qp_rect(lcd_surface, left, top, right, bottom, 0, 0, 0, true);
+            hlc_dirty_mark(left, top, right, bottom);
+            if (life_grid[y] & (1UL << x)) {
+                qp_rect(lcd_surface, left + 1, top + 1, right - 1, bottom - 1, color.h, color.s, color.v, true);
+            }
+        }
+        life_changed[y] = 0;
+    }
+}
+
+// Average ns of a redraw of every cell
+static double time_grid_redraws(void (*draw)(void)) {
+    uint64_t total_ns = 0;
+
+    for (uint32_t i = 0; i < GRID_REDRAWS; i++) {
+        for (uint8_t y = 0; y < GRID_HEIGHT; y++) {
+            life_changed[y] = GRID_ROW_MASK;
+        }
+        uint32_t start = hlc_bench_begin();
+        draw();
+        total_ns += (uint32_t)(hlc_bench_begin() - start);
+        hlc_dirty_sync_surface(lcd_surface, false);
+    }
+    return (double)total_ns / GRID_REDRAWS;
+}
+
+// The same random grid with both, the framebuffers have to come out the same
+static void compare_grid_redraws(void) {
+    static uint16_t before[PIXELS];
+
+    srand(1);
+    for (uint8_t y = 0; y < GRID_HEIGHT; y++) {
+        life_grid[y] = rand() & GRID_ROW_MASK;
+    }
+    color_value = 3;
+
+    double qp_rect_ns = time_grid_redraws(qp_rect_draw_grid);
+    memcpy(before, surface_mock.buffer, sizeof(before));
+    double raster_ns = time_grid_redraws(draw_grid);
+    bool   same      = memcmp(before, surface_mock.buffer, sizeof(before)) == 0;
+
+    printf("grid: %u full redraws of %u cells, qp_rect %.0f ns, rasterizer %.0f ns (%.1fx), framebuffers %s\n", GRID_REDRAWS, GRID_WIDTH * GRID_HEIGHT, qp_rect_ns, raster_ns, qp_rect_ns / raster_ns, same ? "identical" : "differ");
+    failures += !same;
+}
+#endif
+
+static void tick(bool second_display) {
+    test_timer_ms++;
+    test_system_time += 1000;
+    display_module_housekeeping_task_kb(second_display);
+}
+
+int main(int argc, char **argv) {
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--update") == 0) {
+            update_golden = true;
+        } else {
+            golden_dir = argv[arg];
+        }
+    }
+    if (golden_dir == NULL) {
+        fprintf(stderr, "usage: %s [--update] golden_dir\n", argv[0]);
+        return 2;
+    }
+    sim_name = argv[0];
+
+    module_post_init_kb();
+
+    // Layers 0-8 (8 has no colour of its own) and every LED combination, the last ones stay on the display
+    hlc_bench_reset();
+    for (uint32_t i = 0; i < STATUS_TICKS; i++) {
+        layer_state   = 1UL << ((i / 16) % 9);
+        led_state.raw = (i / 24) % 8;
+        tick(false);
+    }
+    report("status", STATUS_TICKS, "ticks");
+    check_image("status");
+
+    // The bench script runs on the first tick after its delay
+    test_timer_ms = HLC_TFT_BENCH_DELAY;
+    tick(false);
+    if (!bench_reported) {
+        printf("bench: didn't run\n");
+        failures++;
+    }
+
+    hlc_bench_reset();
+    for (uint32_t i = 0; i < LIFE_TICKS; i++) {
+        if (i % KEY_EVERY_MS == 0) {
+            activity_time = test_timer_ms;
+        }
+        tick(true);
+    }
+    report("life", LIFE_TICKS, "ticks");
+    check_image("life");
+
+#if !defined(HLC_TFT_INDEXED_FB) && !defined(HLC_TFT_STRIP_RENDER)
+    compare_grid_redraws();
+#endif
+
+    return failures != 0;
+}
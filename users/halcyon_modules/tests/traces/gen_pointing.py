@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+# Copyright 2024 splitkb.com (support@splitkb.com)
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""Writes the synthetic trackpad traces replayed by pointing_replay.c.
+
+Every line is "t_ms x y", the absolute position a Cirque in absolute mode would report every 10 ms, with 0.8 counts
+of gaussian noise. The path stops after its duration and the pointer rests for another 500 ms.
+"""
+import random
+from pathlib import Path
+
+random.seed(1)
+
+
+def write(name, points):
+    with open(Path(__file__).parent / f'pointing_{name}.txt', 'w') as f:
+        for t, x, y in points:
+            f.write(f'{t} {x:.3f} {y:.3f}\n')
+
+
+def noisy(path, duration, dt=10, sd=0.8, tail=500):
+    return [(t, *(c + random.gauss(0, sd) for c in path(min(t, duration)))) for t in range(0, duration + tail, dt)]
+
+
+def flick(t):
+    u = min(t / 80, 1.0)
+    s = u * u * (3 - 2 * u)
+    return (300 + 500 * s, 500 + 100 * s)
+
+
+write('rest', noisy(lambda t: (500, 500), 2000))
+write('slow', noisy(lambda t: (500 + 0.02 * t, 500 + 0.01 * t), 3000))
+write('medium', noisy(lambda t: (500 + 0.3 * t, 500), 800))
+write('flick', noisy(flick, 80))